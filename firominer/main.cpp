@@ -24,6 +24,10 @@
 #define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
 #endif
 
+#include <libcrypto/dispatch.hpp>
+#include <libcrypto/epoch_cache.hpp>
+#include <libcrypto/item_cache.hpp>
+#include <libcrypto/progpow_jit.hpp>
 #include <libethcore/Farm.h>
 #if ETH_ETHASHCL
 #include <libethash-cl/CLMiner.h>
@@ -349,12 +353,43 @@ public:
 
         app.add_option("--cpu-devices,--cp-devices", m_CPSettings.devices, "");
 
+        app.add_option("--cpu-threads,--cp-threads", m_CPSettings.threads, "", true);
+
+        app.add_set("--cpu-placement,--cp-placement", m_CPSettings.placement, {"all", "cores", "l3"}, "", true);
+
+        app.add_option("--cpu-reserve,--cp-reserve", m_CPSettings.reserveCores, "", true);
+
+        app.add_option("--cpu-block-size,--cp-block-size", m_CPSettings.blockSize, "", true)
+            ->check(CLI::Range(16, 1048576));
+
+        app.add_flag("--cpu-jit,--cp-jit", m_CPSettings.jit, "");
+
+        app.add_option("--cpu-jit-cxx,--cp-jit-cxx", m_CPSettings.jitCompiler, "", true);
+
+        app.add_option("--cpu-nonces,--cp-nonces", m_CPSettings.noncesInFlight, "", true)->check(CLI::Range(0, 16));
+
 #endif
 
         app.add_flag("--noeval", m_FarmSettings.noEval, "");
 
+        app.add_set("--verify-mode", m_FarmSettings.verifyMode, {"light", "cached", "full", "off"}, "", true);
+
+        app.add_option("--verify-threads", m_FarmSettings.verifyThreads, "", true)->check(CLI::Range(0, 64));
+
+        app.add_option("--verify-cache", m_verifyCacheMb, "", true)->check(CLI::Range(0, 65536));
+
         app.add_option("-L,--dag-load-mode", m_FarmSettings.dagLoadMode, "", true)->check(CLI::Range(1));
 
+        app.add_set("--host-simd", m_hostSimd, {"auto", "generic", "sse4", "avx2", "avx512"}, "", true);
+
+        app.add_option("--epoch-cache-dir", m_epochCacheDir, "", true);
+
+        app.add_flag("--no-epoch-cache", m_noEpochCache, "");
+
+        app.add_flag("--epoch-cache-dag", m_epochCacheDag, "");
+
+        app.add_option("--epoch-prebuild", m_FarmSettings.prebuildBlocks, "", true)->check(CLI::Range(0, 1300));
+
         bool cl_miner = false;
         app.add_flag("-G,--opencl", cl_miner, "");
 
@@ -403,6 +438,9 @@ public:
         else
             m_minerType = MinerType::Mixed;
 
+        // CPUs may mine alongside the GPUs picked by -G / -U
+        m_cpuMining = cpu_miner;
+
         /*
             Operation mode Simulation do not require pool definitions
             Operation mode Stratum or GetWork do need at least one
@@ -505,7 +543,7 @@ public:
             CUDAMiner::enumDevices(m_DevicesCollection);
 #endif
 #if ETH_ETHASHCPU
-        if (m_minerType == MinerType::CPU)
+        if (m_cpuMining)
             CPUMiner::enumDevices(m_DevicesCollection);
 #endif
 
@@ -531,6 +569,15 @@ public:
 #if ETH_ETHASHCL
             if (m_minerType == MinerType::CL || m_minerType == MinerType::Mixed)
                 cout << setw(5) << "CL   ";
+#endif
+#if ETH_ETHASHCPU
+            if (m_cpuMining)
+            {
+                cout << setw(5) << "Core ";
+                cout << setw(4) << "L3  ";
+                cout << setw(5) << "Node ";
+                cout << setw(5) << "Mine ";
+            }
 #endif
             cout << resetiosflags(ios::left) << setw(13) << "Total Memory"
                  << " ";
@@ -560,6 +607,15 @@ public:
 #if ETH_ETHASHCL
             if (m_minerType == MinerType::CL || m_minerType == MinerType::Mixed)
                 cout << setw(5) << "---- ";
+#endif
+#if ETH_ETHASHCPU
+            if (m_cpuMining)
+            {
+                cout << setw(5) << "---- ";
+                cout << setw(4) << "--- ";
+                cout << setw(5) << "---- ";
+                cout << setw(5) << "---- ";
+            }
 #endif
             cout << resetiosflags(ios::left) << setw(13) << "------------"
                  << " ";
@@ -573,6 +629,12 @@ public:
             }
 #endif
             cout << resetiosflags(ios::left) << endl;
+#if ETH_ETHASHCPU
+            // CPUs the mining threads would be placed on
+            std::vector<unsigned> placedCpus;
+            if (m_cpuMining)
+                placedCpus = CPUMiner::placeThreads(m_CPSettings);
+#endif
             std::map<string, DeviceDescriptor>::iterator it = m_DevicesCollection.begin();
             while (it != m_DevicesCollection.end())
             {
@@ -605,6 +667,23 @@ public:
 #if ETH_ETHASHCL
                 if (m_minerType == MinerType::CL || m_minerType == MinerType::Mixed)
                     cout << setw(5) << (it->second.clDetected ? "Yes" : "");
+#endif
+#if ETH_ETHASHCPU
+                if (m_cpuMining)
+                {
+                    if (it->second.cpDetected)
+                    {
+                        bool placed = std::find(placedCpus.begin(), placedCpus.end(),
+                                          (unsigned)it->second.cpCpuNumer) != placedCpus.end();
+                        cout << setw(5) << it->second.cpCore;
+                        cout << setw(4) << it->second.cpL3;
+                        cout << setw(5)
+                             << (it->second.cpNumaNode >= 0 ? std::to_string(it->second.cpNumaNode) : "-");
+                        cout << setw(5) << (placed ? "Yes" : "");
+                    }
+                    else
+                        cout << setw(19) << "";
+                }
 #endif
                 cout << resetiosflags(ios::left) << setw(13)
                      << getFormattedMemory((double)it->second.totalMemory) << " ";
@@ -666,15 +745,21 @@ public:
         }
 #endif
 #if ETH_ETHASHCPU
-        if (m_CPSettings.devices.size() && (m_minerType == MinerType::CPU))
+        if (m_CPSettings.devices.size() && m_cpuMining)
         {
+            unsigned threads = 0;
             for (auto index : m_CPSettings.devices)
             {
                 if (index < m_DevicesCollection.size())
                 {
                     auto it = m_DevicesCollection.begin();
                     std::advance(it, index);
+                    if (!it->second.cpDetected)
+                        throw std::runtime_error("Can't CPU subscribe a non-CPU device.");
+                    if (m_CPSettings.threads && threads == m_CPSettings.threads)
+                        break;
                     it->second.subscriptionType = DeviceSubscriptionTypeEnum::Cpu;
+                    threads++;
                 }
             }
         }
@@ -709,11 +794,14 @@ public:
         }
 #endif
 #if ETH_ETHASHCPU
-        if (!m_CPSettings.devices.size() &&
-            (m_minerType == MinerType::CPU))
+        if (!m_CPSettings.devices.size() && m_cpuMining)
         {
-            for (auto it = m_DevicesCollection.begin(); it != m_DevicesCollection.end(); it++)
+            for (auto cpu : CPUMiner::placeThreads(m_CPSettings))
             {
+                auto it = m_DevicesCollection.find("cpu-" + std::to_string(cpu));
+                if (it == m_DevicesCollection.end() ||
+                    it->second.subscriptionType != DeviceSubscriptionTypeEnum::None)
+                    continue;
                 it->second.subscriptionType = DeviceSubscriptionTypeEnum::Cpu;
             }
         }
@@ -740,6 +828,47 @@ public:
         signal(SIGINT, MinerCLI::signalHandler);
         signal(SIGTERM, MinerCLI::signalHandler);
 
+        // Pick host side hashing kernels (DAG build, verification, CPU mining)
+        if (m_hostSimd != "auto")
+            crypto::select_simd_level(*crypto::simd_level_from_string(m_hostSimd));
+        cnote << "Host SIMD : detected " << crypto::to_string(crypto::detected_simd_level())
+              << ", using " << crypto::to_string(crypto::active_simd_level());
+
+        // Persist host side epoch contexts (light caches, CPU DAGs) across restarts
+        if (!m_noEpochCache)
+        {
+            if (m_epochCacheDir.empty())
+                m_epochCacheDir = defaultEpochCacheDir();
+            if (!m_epochCacheDir.empty())
+            {
+                boost::system::error_code ec;
+                boost::filesystem::create_directories(m_epochCacheDir, ec);
+                if (ec)
+                {
+                    cwarn << "Epoch cache disabled : " << m_epochCacheDir << " " << ec.message();
+                }
+                else
+                {
+                    ethash::set_epoch_cache_dir(m_epochCacheDir);
+                    ethash::set_epoch_cache_full_datasets(m_epochCacheDag);
+                    cnote << "Epoch cache : " << m_epochCacheDir << (m_epochCacheDag ? " (with DAGs)" : "");
+                }
+            }
+        }
+
+        // Dataset items computed by light contexts (solution verification)
+        if (m_FarmSettings.noEval)
+            m_FarmSettings.verifyMode = "off";
+        ethash::set_dataset_item_cache_size(
+            m_FarmSettings.verifyMode == "light" ? 0 : size_t(m_verifyCacheMb) << 20);
+        cnote << "Verify mode : " << m_FarmSettings.verifyMode;
+
+#if ETH_ETHASHCPU
+        // Native ProgPoW programs, used by CPU mining and solution verification
+        if (m_CPSettings.jit)
+            progpow::set_jit_compiler(m_CPSettings.jitCompiler);
+#endif
+
         // Initialize Farm
         new Farm(m_DevicesCollection, m_FarmSettings, m_CUSettings, m_CLSettings, m_CPSettings);
 
@@ -747,6 +876,17 @@ public:
         doMiner();
     }
 
+    static string defaultEpochCacheDir()
+    {
+#if defined(__linux__) || defined(__APPLE__)
+        if (const char* xdg = getenv("XDG_CACHE_HOME"); xdg && *xdg)
+            return string(xdg) + "/firominer";
+        if (const char* home = getenv("HOME"); home && *home)
+            return string(home) + "/.cache/firominer";
+#endif
+        return string();
+    }
+
     void help()
     {
         cout << "firominer - GPU ProgPOW(0.9.3) miner for Zing" << endl
@@ -764,7 +904,7 @@ public:
              << "    -U,--cuda           Mine/Benchmark using CUDA only" << endl
 #endif
 #if ETH_ETHASHCPU
-             << "    --cpu               Development ONLY ! (NO MINING)" << endl
+             << "    --cpu               Mine with the CPUs, alone or along with -G or -U" << endl
 #endif
              << endl
              << "Connection options :" << endl
@@ -955,6 +1095,31 @@ public:
                  << "                        Space separated list of device indexes to use" << endl
                  << "                        eg --cp-devices 0 2 3" << endl
                  << "                        If not set all available CPUs will be used" << endl
+                 << "    --cp-threads        UINT Default = 0" << endl
+                 << "                        Number of mining threads, each bound to one of" << endl
+                 << "                        the CPUs above. 0 uses all of them" << endl
+                 << "    --cp-placement      TEXT {all,cores,l3} Default = cores" << endl
+                 << "                        Where threads go when --cp-devices is not set" << endl
+                 << "                        'all'   Every logical CPU, SMT siblings included" << endl
+                 << "                        'cores' One per physical core, spread over the" << endl
+                 << "                                L3 cache domains" << endl
+                 << "                        'l3'    One per physical core, filling an L3" << endl
+                 << "                                domain before the next" << endl
+                 << "                        --list-devices --cpu shows the topology and" << endl
+                 << "                        the CPUs picked" << endl
+                 << "    --cp-reserve        UINT Default = 0" << endl
+                 << "                        Number of physical cores, from the first one," << endl
+                 << "                        left free for GPU feeder and network threads" << endl
+                 << "    --cp-block-size     UINT[16 .. 1048576] Default = 512" << endl
+                 << "                        Nonces each thread hashes between checks for" << endl
+                 << "                        new work" << endl
+                 << "    --cp-jit            FLAG Compile the ProgPoW program of each period" << endl
+                 << "                        to native code with the host compiler" << endl
+                 << "    --cp-jit-cxx        TEXT Default = \"c++ -O3 -march=native\"" << endl
+                 << "                        Compiler command used by --cp-jit" << endl
+                 << "    --cp-nonces         UINT[0 .. 16] Default = 0" << endl
+                 << "                        Nonces hashed interleaved by each CPU thread to" << endl
+                 << "                        hide DAG latency. 0 picks a value for the host CPU" << endl
                  << endl;
         }
 
@@ -1018,6 +1183,21 @@ public:
                  << "                        found nonces. Trims some ms. from submission" << endl
                  << "                        time but it may increase rejected solution rate."
                  << endl
+                 << "    --verify-mode       TEXT {light,cached,full,off} Default = cached" << endl
+                 << "                        How found nonces are re-evaluated on the host" << endl
+                 << "                        'light'  From the light cache only, least memory" << endl
+                 << "                        'cached' As light, keeping computed DAG items" << endl
+                 << "                                 (see --verify-cache)" << endl
+                 << "                        'full'   Builds the DAG on the host in background" << endl
+                 << "                                 and switches to it once ready. Fastest," << endl
+                 << "                                 needs the DAG size in free RAM" << endl
+                 << "                        'off'    Same as --noeval" << endl
+                 << "    --verify-threads    UINT[0 .. 64] Default = 0" << endl
+                 << "                        Threads re-evaluating found nonces, away from the" << endl
+                 << "                        network thread. 0 picks a number for the host" << endl
+                 << "    --verify-cache      UINT[0 .. 65536] Default = 256" << endl
+                 << "                        MiB of dataset items kept once computed by the" << endl
+                 << "                        verification threads, per epoch. 0 disables it" << endl
                  << "    --list-devices      FLAG Lists the detected OpenCL/CUDA devices and "
                     "exits"
                  << endl
@@ -1026,6 +1206,27 @@ public:
                  << "                        Set DAG load mode. Can be one of:" << endl
                  << "                        0 Parallel load mode (each GPU independently)" << endl
                  << "                        1 Sequential load mode (one GPU after another)" << endl
+                 << "    --host-simd         TEXT {auto,generic,sse4,avx2,avx512} Default = auto"
+                 << endl
+                 << "                        Instruction set used by host side hashing (DAG" << endl
+                 << "                        build, solution verification, CPU mining)." << endl
+                 << "                        Higher levels than detected are clamped down." << endl
+                 << "    --epoch-cache-dir   TEXT Default = $XDG_CACHE_HOME/firominer or" << endl
+                 << "                        ~/.cache/firominer" << endl
+                 << "                        Directory where host side epoch data (light cache," << endl
+                 << "                        CPU mining DAG) is stored to skip rebuilding it" << endl
+                 << "                        on restart. Not available on Windows." << endl
+                 << "    --no-epoch-cache    FLAG Do not store nor load epoch data on disk" << endl
+                 << "    --epoch-cache-dag   FLAG Also store full DAGs (CPU mining, --verify-mode" << endl
+                 << "                        full), several GB each. By default only light" << endl
+                 << "                        caches are stored" << endl
+                 << "    --epoch-prebuild    UINT[0 .. 1300] Default = 30" << endl
+                 << "                        Blocks before an epoch change to start building" << endl
+                 << "                        the next epoch's host data (light cache, CPU" << endl
+                 << "                        mining and --verify-mode full DAGs) at low" << endl
+                 << "                        priority, so the change itself is immediate." << endl
+                 << "                        GPU DAGs are still generated at the change." << endl
+                 << "                        0 disables it" << endl
                  << endl
                  << "    --tstart            UINT[30 .. 100] Default = 0" << endl
                  << "                        Suspend mining on GPU which temperature is above"
@@ -1251,8 +1452,14 @@ private:
 
     // Mining options
     MinerType m_minerType = MinerType::Mixed;
+    bool m_cpuMining = false;  // CPUs mine, alone or along with GPUs
     OperationMode m_mode = OperationMode::None;
     bool m_shouldListDevices = false;
+    string m_hostSimd = "auto";
+    string m_epochCacheDir;
+    bool m_noEpochCache = false;
+    bool m_epochCacheDag = false;
+    unsigned m_verifyCacheMb = 256;
 
     FarmSettings m_FarmSettings;  // Operating settings for Farm
     PoolSettings m_PoolSettings;  // Operating settings for PoolManager
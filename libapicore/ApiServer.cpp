@@ -1067,11 +1067,20 @@ Json::Value ApiConnection::getMinerStatDetailPerMiner(
     mininginfo["paused"] = _miner->paused();
     mininginfo["pause_reason"] = _miner->paused() ? _miner->pausedString() : Json::Value::null;
 
-    /* Nonce infos */
-    auto segment_width = Farm::f().get_segment_width();
-    uint64_t gpustartnonce = Farm::f().get_nonce_scrambler() + ((uint64_t)_index << segment_width);
-    jsegment.append(toHex(uint64_t(gpustartnonce), HexPrefix::Add));
-    jsegment.append(toHex(uint64_t(gpustartnonce + (1LL << segment_width)), HexPrefix::Add));
+    /* Nonce infos: what is left of the device's range of the current job */
+    auto coverage = Farm::f().getNonceCoverage();
+    if (_index < coverage.lanes.size())
+    {
+        jsegment.append(toHex(coverage.lanes[_index].next, HexPrefix::Add));
+        jsegment.append(toHex(coverage.lanes[_index].end, HexPrefix::Add));
+    }
+    else
+    {
+        auto segment_width = Farm::f().get_segment_width();
+        uint64_t gpustartnonce = Farm::f().get_nonce_scrambler() + ((uint64_t)_index << segment_width);
+        jsegment.append(toHex(uint64_t(gpustartnonce), HexPrefix::Add));
+        jsegment.append(toHex(uint64_t(gpustartnonce + (1LL << segment_width)), HexPrefix::Add));
+    }
     mininginfo["segment"] = jsegment;
 
     /* Hash & Share infos */
@@ -1246,6 +1255,32 @@ Json::Value ApiConnection::getMinerStatDetail()
                                                                 // found share
     mininginfo["shares"] = sharesinfo;
 
+    VerifierStats vs = Farm::f().getVerifierStats();
+    Json::Value verifierinfo;
+    verifierinfo["threads"] = vs.threads;
+    verifierinfo["verified"] = vs.verified;
+    verifierinfo["failed"] = vs.failed;
+    verifierinfo["unverified"] = vs.unverified;
+    verifierinfo["throttled"] = vs.throttled;
+    verifierinfo["queued"] = vs.queued;
+    verifierinfo["max_queued"] = vs.maxQueued;
+    verifierinfo["avg_us"] = vs.avgMicros;
+    verifierinfo["max_us"] = vs.maxMicros;
+    verifierinfo["cache_hits"] = vs.cacheHits;
+    verifierinfo["cache_misses"] = vs.cacheMisses;
+    verifierinfo["mode"] = vs.mode;
+    verifierinfo["full_ready"] = vs.fullReady;
+    const std::pair<const char*, const VerifierStats::Backend*> backends[] = {{"light", &vs.light}, {"full", &vs.full}};
+    for (const auto& backend : backends)
+    {
+        Json::Value backendinfo;
+        backendinfo["verified"] = backend.second->verified;
+        backendinfo["avg_us"] = backend.second->avgMicros;
+        backendinfo["avg_cpu_us"] = backend.second->avgCpuMicros;
+        verifierinfo[backend.first] = backendinfo;
+    }
+    mininginfo["verifier"] = verifierinfo;
+
     /* Monitors Info */
     Json::Value monitorinfo;
     auto tstop = Farm::f().get_tstop();
@@ -45,4 +45,21 @@
 #define NO_SANITIZE(sanitizer)
 #endif
 
+// Software prefetch of a cache line for reading
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define PREFETCH(addr)
+#endif
+
+// Per function x86 instruction set targets, used to build the
+// SIMD variants of hot kernels selected at runtime (see dispatch.hpp)
+#if defined(__x86_64__) && __has_attribute(target)
+#define HAVE_X86_TARGET_DISPATCH 1
+#define ATTRIBUTE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define HAVE_X86_TARGET_DISPATCH 0
+#define ATTRIBUTE_TARGET(isa)
+#endif
+
 #endif  // !CRYPTO_ATTRIBUTES_HPP_
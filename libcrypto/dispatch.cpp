@@ -0,0 +1,100 @@
+// firominer: runtime CPU feature dispatch for libcrypto hot kernels.
+// Licensed under the Apache License, Version 2.0.
+
+// Written by Firominer's authors 2021
+
+#include <atomic>
+
+#include "dispatch.hpp"
+
+namespace crypto
+{
+namespace
+{
+std::atomic<simd_level> active_level{simd_level::generic};
+
+simd_level probe_simd_level() noexcept
+{
+#if HAVE_X86_TARGET_DISPATCH
+    // Init CPU information.
+    // This is needed on macOS because of the bug: https://bugs.llvm.org/show_bug.cgi?id=48459.
+    __builtin_cpu_init();
+
+    if (!__builtin_cpu_supports("sse4.1") || !__builtin_cpu_supports("sse4.2"))
+        return simd_level::generic;
+
+    // Check if both BMI and BMI2 are supported. Some CPUs like Intel E5-2697 v2 incorrectly
+    // report BMI2 but not BMI being available.
+    if (!__builtin_cpu_supports("avx2") || !__builtin_cpu_supports("bmi") || !__builtin_cpu_supports("bmi2"))
+        return simd_level::sse4;
+
+    if (!__builtin_cpu_supports("avx512f"))
+        return simd_level::avx2;
+
+    return simd_level::avx512;
+#else
+    return simd_level::generic;
+#endif
+}
+
+}  // namespace
+
+simd_level detected_simd_level() noexcept
+{
+    static const simd_level detected{probe_simd_level()};
+    return detected;
+}
+
+simd_level active_simd_level() noexcept
+{
+    return active_level.load(std::memory_order_relaxed);
+}
+
+simd_level select_simd_level(simd_level level) noexcept
+{
+    if (level > detected_simd_level())
+        level = detected_simd_level();
+
+    detail::select_keccak_kernels(level);
+    detail::select_ethash_kernels(level);
+    detail::select_progpow_kernels(level);
+
+    active_level.store(level, std::memory_order_relaxed);
+    return level;
+}
+
+std::string to_string(simd_level level)
+{
+    switch (level)
+    {
+    case simd_level::sse4:
+        return "sse4";
+    case simd_level::avx2:
+        return "avx2";
+    case simd_level::avx512:
+        return "avx512";
+    default:
+        return "generic";
+    }
+}
+
+std::optional<simd_level> simd_level_from_string(const std::string& name) noexcept
+{
+    for (auto level : {simd_level::generic, simd_level::sse4, simd_level::avx2, simd_level::avx512})
+    {
+        if (name == to_string(level))
+            return level;
+    }
+    return std::nullopt;
+}
+
+#if HAVE_X86_TARGET_DISPATCH
+// Dispatch to the best tier as soon as the library is loaded so hashing
+// is at full speed even if the application never selects a tier.
+__attribute__((constructor)) static void select_detected_simd_level()
+{
+    select_simd_level(detected_simd_level());
+}
+#endif
+
+}  // namespace crypto
@@ -0,0 +1,69 @@
+// firominer: runtime CPU feature dispatch for libcrypto hot kernels.
+// Licensed under the Apache License, Version 2.0.
+
+// Written by Firominer's authors 2021
+
+#pragma once
+#ifndef CRYPTO_DISPATCH_HPP_
+#define CRYPTO_DISPATCH_HPP_
+
+#include <optional>
+#include <string>
+
+#include "attributes.hpp"
+
+namespace crypto
+{
+/**
+ * Instruction set tiers libcrypto hot kernels are built for, in increasing order.
+ * Each tier implies all the lower ones.
+ *
+ * generic  Plain C++ as compiled by the project settings
+ * sse4     SSE4.1 / SSE4.2
+ * avx2     AVX2 + BMI1 + BMI2
+ * avx512   AVX-512F on top of avx2
+ */
+enum class simd_level
+{
+    generic,
+    sse4,
+    avx2,
+    avx512
+};
+
+/**
+ * Returns the highest tier supported by the host.
+ * The CPU is probed once, on first call.
+ */
+simd_level detected_simd_level() noexcept;
+
+/**
+ * Returns the tier the kernels are currently dispatched to.
+ */
+simd_level active_simd_level() noexcept;
+
+/**
+ * Dispatches all kernels to the given tier, clamped to the detected one.
+ * Kernels are switched by plain pointer stores thus this is meant to be
+ * called at startup, before any hashing thread runs.
+ *
+ * @param level     The wanted tier
+ * @return          The tier actually in use
+ */
+simd_level select_simd_level(simd_level level) noexcept;
+
+std::string to_string(simd_level level);
+
+std::optional<simd_level> simd_level_from_string(const std::string& name) noexcept;
+
+namespace detail
+{
+// Per module kernel selectors invoked on every tier switch
+void select_keccak_kernels(simd_level level) noexcept;
+void select_ethash_kernels(simd_level level) noexcept;
+void select_progpow_kernels(simd_level level) noexcept;
+}  // namespace detail
+
+}  // namespace crypto
+
+#endif  // !CRYPTO_DISPATCH_HPP_
@@ -0,0 +1,290 @@
+// firominer: persistent on-disk store of ethash epoch contexts.
+// Licensed under the Apache License, Version 2.0.
+
+// Written by Firominer's authors 2021
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HAVE_EPOCH_CACHE 1
+#else
+#define HAVE_EPOCH_CACHE 0
+#endif
+
+#include "epoch_cache.hpp"
+
+namespace ethash
+{
+namespace
+{
+std::mutex cache_dir_mutex;
+std::string cache_dir;
+bool cache_full_datasets{false};
+
+// Bump whenever the layout of the files changes
+constexpr uint32_t kCache_format_version = 1;
+constexpr char kCache_magic[8] = {'F', 'I', 'R', 'O', 'E', 'P', 'C', '\0'};
+
+// Data starts one page after the header so the mapped caches stay page aligned
+constexpr size_t kCache_header_size = 4096;
+
+struct cache_header
+{
+    char magic[8];
+    uint32_t format_version;
+    uint32_t revision;
+    uint32_t epoch_number;
+    uint32_t full;
+    uint32_t light_cache_num_items;
+    uint32_t full_dataset_num_items;
+    uint64_t data_size;
+    uint64_t checksum;
+};
+static_assert(sizeof(cache_header) <= kCache_header_size, "cache header does not fit its page");
+
+std::string cache_file_name(uint32_t epoch_number, bool full)
+{
+    char name[64];
+    std::snprintf(name, sizeof(name), "ethash-r%u-e%05u.%s", kRevision, epoch_number, full ? "full" : "light");
+    return name;
+}
+
+size_t dataset_size(const epoch_context& context) noexcept
+{
+    return context.full_dataset ? context.full_dataset_size : kL1_cache_size;
+}
+
+/// FNV-1a over 64-bit words, in 4 interleaved streams to not be latency bound.
+/// Sizes are always a multiple of a light cache item.
+uint64_t checksum(const void* data, size_t size) noexcept
+{
+    static constexpr uint64_t prime{0x100000001b3};
+    const auto* const words{static_cast<const uint64_t*>(data)};
+    uint64_t h[4]{0xcbf29ce484222325, 0xcbf29ce484222325, 0xcbf29ce484222325, 0xcbf29ce484222325};
+    for (size_t i{0}; i < size / sizeof(uint64_t); i += 4)
+    {
+        for (size_t j{0}; j < 4; ++j)
+            h[j] = (h[j] ^ words[i + j]) * prime;
+    }
+    return ((h[0] * prime ^ h[1]) * prime ^ h[2]) * prime ^ h[3];
+}
+
+#if HAVE_EPOCH_CACHE
+bool write_all(int fd, const void* data, size_t size) noexcept
+{
+    const auto* p{static_cast<const char*>(data)};
+    while (size)
+    {
+        const ssize_t written{::write(fd, p, size)};
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        p += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+/// Removes the files of a previous revision or of epochs older than the previous one
+void prune_cache_dir(const std::string& dir, uint32_t epoch_number) noexcept
+{
+    DIR* d{::opendir(dir.c_str())};
+    if (!d)
+        return;
+    while (const dirent* entry = ::readdir(d))
+    {
+        unsigned revision{0};
+        unsigned epoch{0};
+        char kind[8]{};
+        if (std::sscanf(entry->d_name, "ethash-r%u-e%u.%7s", &revision, &epoch, kind) != 3)
+            continue;
+        if (revision != kRevision || epoch + 1 < epoch_number)
+            ::unlink((dir + "/" + entry->d_name).c_str());
+    }
+    ::closedir(d);
+}
+#endif
+
+}  // namespace
+
+void set_epoch_cache_dir(const std::string& dir)
+{
+    std::lock_guard<std::mutex> lock{cache_dir_mutex};
+    cache_dir = dir;
+    while (cache_dir.size() > 1 && cache_dir.back() == '/')
+        cache_dir.pop_back();
+}
+
+std::string get_epoch_cache_dir()
+{
+    std::lock_guard<std::mutex> lock{cache_dir_mutex};
+    return cache_dir;
+}
+
+void set_epoch_cache_full_datasets(bool enabled)
+{
+    std::lock_guard<std::mutex> lock{cache_dir_mutex};
+    cache_full_datasets = enabled;
+}
+
+namespace detail
+{
+bool epoch_cache_enabled(bool full) noexcept
+{
+#if HAVE_EPOCH_CACHE
+    std::lock_guard<std::mutex> lock{cache_dir_mutex};
+    return !cache_dir.empty() && (!full || cache_full_datasets);
+#else
+    (void)full;
+    return false;
+#endif
+}
+
+epoch_context* load_epoch_context(uint32_t epoch_number, bool full) noexcept
+{
+#if HAVE_EPOCH_CACHE
+    const std::string dir{get_epoch_cache_dir()};
+    if (dir.empty() || !epoch_cache_enabled(full))
+        return nullptr;
+    const std::string path{dir + "/" + cache_file_name(epoch_number, full)};
+
+    const int fd{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (fd < 0)
+        return nullptr;
+
+    const uint32_t light_cache_num_items{calculate_light_cache_num_items(epoch_number)};
+    const uint32_t full_dataset_num_items{calculate_full_dataset_num_items(epoch_number)};
+    const size_t light_cache_size{get_light_cache_size(light_cache_num_items)};
+    const size_t full_dataset_size{get_full_dataset_size(full_dataset_num_items)};
+    const size_t data_size{light_cache_size + (full ? full_dataset_size : kL1_cache_size)};
+
+    cache_header header{};
+    struct stat st{};
+    const bool valid_header{::pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                            ::fstat(fd, &st) == 0 &&
+                            std::memcmp(header.magic, kCache_magic, sizeof(kCache_magic)) == 0 &&
+                            header.format_version == kCache_format_version && header.revision == kRevision &&
+                            header.epoch_number == epoch_number && header.full == (full ? 1u : 0u) &&
+                            header.light_cache_num_items == light_cache_num_items &&
+                            header.full_dataset_num_items == full_dataset_num_items &&
+                            header.data_size == data_size &&
+                            static_cast<size_t>(st.st_size) == kCache_header_size + data_size};
+    if (!valid_header)
+    {
+        ::close(fd);
+        return nullptr;
+    }
+
+    int flags{MAP_PRIVATE};
+#if defined(MAP_POPULATE)
+    // Pages are all going to be checksummed then hashed from
+    flags |= MAP_POPULATE;
+#endif
+    void* const mapping{::mmap(nullptr, kCache_header_size + data_size, PROT_READ, flags, fd, 0)};
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        return nullptr;
+
+    char* const data{static_cast<char*>(mapping) + kCache_header_size};
+    if (checksum(data, data_size) != header.checksum)
+    {
+        // Corrupted. Drop it so it gets rebuilt and stored again
+        ::munmap(mapping, kCache_header_size + data_size);
+        ::unlink(path.c_str());
+        return nullptr;
+    }
+
+    void* const alloc_data{std::malloc(sizeof(epoch_context))};
+    if (!alloc_data)
+    {
+        ::munmap(mapping, kCache_header_size + data_size);
+        return nullptr;
+    }
+
+    auto* const light_cache{reinterpret_cast<hash512*>(data)};
+    auto* const l1_cache{reinterpret_cast<uint32_t*>(data + light_cache_size)};
+    return new (alloc_data) epoch_context{epoch_number, light_cache_num_items, light_cache_size,
+        full_dataset_num_items, full_dataset_size, light_cache, l1_cache,
+        full ? reinterpret_cast<hash1024*>(l1_cache) : nullptr};
+#else
+    (void)epoch_number;
+    (void)full;
+    return nullptr;
+#endif
+}
+
+void unload_epoch_context(epoch_context* context) noexcept
+{
+#if HAVE_EPOCH_CACHE
+    auto* const mapping{const_cast<char*>(reinterpret_cast<const char*>(context->light_cache)) - kCache_header_size};
+    ::munmap(mapping, kCache_header_size + context->light_cache_size + dataset_size(*context));
+#endif
+    context->~epoch_context();
+    std::free(context);
+}
+
+bool store_epoch_context(const epoch_context& context) noexcept
+{
+#if HAVE_EPOCH_CACHE
+    const bool full{context.full_dataset != nullptr};
+    const std::string dir{get_epoch_cache_dir()};
+    if (dir.empty() || !epoch_cache_enabled(full))
+        return false;
+    const std::string path{dir + "/" + cache_file_name(context.epoch_number, full)};
+    const std::string tmp_path{path + ".tmp" + std::to_string(::getpid())};
+
+    // Light cache and l1_cache / full dataset are contiguous (see create_epoch_context)
+    const auto* const data{reinterpret_cast<const char*>(context.light_cache)};
+    const size_t data_size{context.light_cache_size + dataset_size(context)};
+
+    cache_header header{};
+    std::memcpy(header.magic, kCache_magic, sizeof(kCache_magic));
+    header.format_version = kCache_format_version;
+    header.revision = kRevision;
+    header.epoch_number = context.epoch_number;
+    header.full = full ? 1 : 0;
+    header.light_cache_num_items = context.light_cache_num_items;
+    header.full_dataset_num_items = context.full_dataset_num_items;
+    header.data_size = data_size;
+    header.checksum = checksum(data, data_size);
+
+    char page[kCache_header_size]{};
+    std::memcpy(page, &header, sizeof(header));
+
+    const int fd{::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+    if (fd < 0)
+        return false;
+    bool ok{write_all(fd, page, sizeof(page)) && write_all(fd, data, data_size)};
+    ok = (::close(fd) == 0) && ok;
+
+    // Publish atomically so a concurrent or later run never maps a partial file
+    if (!ok || ::rename(tmp_path.c_str(), path.c_str()) != 0)
+    {
+        ::unlink(tmp_path.c_str());
+        return false;
+    }
+
+    prune_cache_dir(dir, context.epoch_number);
+    return true;
+#else
+    (void)context;
+    return false;
+#endif
+}
+
+}  // namespace detail
+
+}  // namespace ethash
@@ -0,0 +1,70 @@
+// firominer: persistent on-disk store of ethash epoch contexts.
+// Licensed under the Apache License, Version 2.0.
+
+// Written by Firominer's authors 2021
+
+#pragma once
+#ifndef CRYPTO_EPOCH_CACHE_HPP_
+#define CRYPTO_EPOCH_CACHE_HPP_
+
+#include <string>
+
+#include "ethash.hpp"
+
+namespace ethash
+{
+/**
+ * Sets the directory where epoch contexts are persisted. Once set, get_epoch_context()
+ * maps read-only the context of an epoch stored by a previous run, or stores it in the
+ * background after having built it. Files are keyed by epoch number, dataset kind and
+ * kRevision and are checksummed. The directory must exist.
+ * Persistence is only supported on POSIX hosts and is disabled by default. Only light
+ * contexts are persisted unless set_epoch_cache_full_datasets() enables full ones.
+ *
+ * @param dir       The cache directory. Empty disables persistence
+ */
+void set_epoch_cache_dir(const std::string& dir);
+
+/**
+ * Returns the directory set by set_epoch_cache_dir()
+ */
+std::string get_epoch_cache_dir();
+
+/**
+ * Enables persisting contexts with a full dataset, several GB each.
+ * Disabled by default.
+ */
+void set_epoch_cache_full_datasets(bool enabled);
+
+
+namespace detail
+{
+/**
+ * Returns whether contexts of the given kind are loaded from and stored to the cache
+ */
+bool epoch_cache_enabled(bool full) noexcept;
+
+/**
+ * Maps the stored context of the given epoch.
+ *
+ * @return          The context or nullptr if missing, stale or corrupted
+ */
+epoch_context* load_epoch_context(uint32_t epoch_number, bool full) noexcept;
+
+/**
+ * Releases a context returned by load_epoch_context()
+ */
+void unload_epoch_context(epoch_context* context) noexcept;
+
+/**
+ * Stores the context and removes the files of older epochs.
+ *
+ * @return          True on success. Failures leave no partial files behind
+ */
+bool store_epoch_context(const epoch_context& context) noexcept;
+
+}  // namespace detail
+
+}  // namespace ethash
+
+#endif  // !CRYPTO_EPOCH_CACHE_HPP_
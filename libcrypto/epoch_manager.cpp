@@ -0,0 +1,341 @@
+// firominer: process wide manager of resident ethash epoch contexts.
+// Licensed under the Apache License, Version 2.0.
+
+// Written by Firominer's authors 2021
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "epoch_cache.hpp"
+#include "epoch_manager.hpp"
+#include "ethash.hpp"
+
+namespace ethash
+{
+namespace
+{
+/// Resident contexts are identified by epoch, kind and NUMA node (-1 if not bound)
+struct context_key
+{
+    uint32_t epoch_number;
+    bool full;
+    int numa_node;
+
+    bool operator==(const context_key& other) const noexcept
+    {
+        return epoch_number == other.epoch_number && full == other.full && numa_node == other.numa_node;
+    }
+};
+
+using context_future = std::shared_future<std::shared_ptr<epoch_context>>;
+
+class epoch_context_manager
+{
+public:
+    static epoch_context_manager& instance()
+    {
+        // Never destroyed: pins may be released after static destruction began
+        static auto* manager{new epoch_context_manager};
+        return *manager;
+    }
+
+    std::shared_ptr<epoch_context> acquire(const context_key& key)
+    {
+        std::promise<std::shared_ptr<epoch_context>> promise;
+        context_future future;
+        context_future sibling;
+        bool build{false};
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            auto it{find(key)};
+            if (it == m_entries.end())
+            {
+                build = true;
+                m_entries.push_back({key, expected_memory(key), promise.get_future().share(), 0, 0});
+                it = std::prev(m_entries.end());
+
+                // Full replicas on other nodes are copied rather than built twice
+                if (key.full && key.numa_node >= 0)
+                {
+                    for (const auto& entry : m_entries)
+                    {
+                        if (entry.key.epoch_number == key.epoch_number && entry.key.full &&
+                            entry.key.numa_node >= 0 && !(entry.key == key))
+                        {
+                            sibling = entry.context;
+                            break;
+                        }
+                    }
+                }
+                evict_over_limits();
+                it = find(key);
+            }
+            ++it->pins;
+            it->last_used = ++m_tick;
+            future = it->context;
+        }
+
+        // Built out of the lock: other epochs and kinds stay available meanwhile
+        // and requests for the same one wait on the future
+        if (build)
+        {
+            std::shared_ptr<epoch_context> created;
+            bool built{false};
+            try
+            {
+                created = make_context(key, sibling, built);
+                promise.set_value(created);
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+                std::lock_guard<std::mutex> lock{m_mutex};
+                auto it{find(key)};
+                if (it != m_entries.end())
+                    m_entries.erase(it);
+            }
+
+            // Waiters are released first, writing a full dataset takes a while
+            if (built && detail::epoch_cache_enabled(key.full))
+                store_async(key, std::move(created));
+        }
+
+        const std::shared_ptr<epoch_context>& context{future.get()};
+        return {context.get(), [key](epoch_context*) { instance().unpin(key); }};
+    }
+
+    void set_limits(const epoch_manager_limits& limits)
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_limits = limits;
+        evict_over_limits();
+    }
+
+    size_t memory() noexcept
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        size_t total{0};
+        for (const auto& entry : m_entries)
+            total += entry.memory_size;
+        return total;
+    }
+
+private:
+    struct entry
+    {
+        context_key key;
+        size_t memory_size;
+        context_future context;
+        unsigned pins;
+        uint64_t last_used;
+    };
+
+    epoch_context_manager() = default;
+
+    std::vector<entry>::iterator find(const context_key& key)
+    {
+        return std::find_if(
+            m_entries.begin(), m_entries.end(), [&key](const entry& e) { return e.key == key; });
+    }
+
+    static size_t expected_memory(const context_key& key) noexcept
+    {
+        const size_t light_cache_size{get_light_cache_size(calculate_light_cache_num_items(key.epoch_number))};
+        const size_t dataset_size{
+            key.full ? get_full_dataset_size(calculate_full_dataset_num_items(key.epoch_number)) : kL1_cache_size};
+        return sizeof(epoch_context) + light_cache_size + dataset_size;
+    }
+
+    /// Sets built when the context was neither cloned nor loaded from the cache
+    static std::shared_ptr<epoch_context> make_context(
+        const context_key& key, const context_future& sibling, bool& built)
+    {
+        if (sibling.valid())
+        {
+            try
+            {
+                const auto& source{sibling.get()};
+                return {detail::clone_epoch_context(*source, key.numa_node), detail::destroy_epoch_context};
+            }
+            catch (...)
+            {
+                // The sibling failed, try on our own
+            }
+        }
+
+        // Map the context stored by a previous run if any, otherwise build it.
+        if (auto* stored = detail::load_epoch_context(key.epoch_number, key.full))
+        {
+            if (key.numa_node < 0)
+                return {stored, detail::unload_epoch_context};
+
+            std::shared_ptr<epoch_context> context{
+                detail::clone_epoch_context(*stored, key.numa_node), detail::destroy_epoch_context};
+            detail::unload_epoch_context(stored);
+            return context;
+        }
+
+        dataset_build_options options;
+        options.numa_node = key.numa_node;
+        epoch_context* const created{detail::create_epoch_context(key.epoch_number, key.full, options)};
+        if (!created)
+            throw std::runtime_error("Epoch context build cancelled");
+        built = true;
+        return {created, detail::destroy_epoch_context};
+    }
+
+    /// Stores the context on a detached thread, pinned meanwhile so it is not
+    /// evicted while written
+    void store_async(const context_key& key, std::shared_ptr<epoch_context> context)
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            auto it{find(key)};
+            if (it == m_entries.end())
+                return;
+            ++it->pins;
+        }
+        try
+        {
+            std::thread([key, context]() {
+                detail::store_epoch_context(*context);
+                instance().unpin(key);
+            }).detach();
+        }
+        catch (...)
+        {
+            unpin(key);
+        }
+    }
+
+    void unpin(const context_key& key) noexcept
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        auto it{find(key)};
+        if (it != m_entries.end() && it->pins)
+            --it->pins;
+        evict_over_limits();
+    }
+
+    bool evictable(const entry& e) const noexcept
+    {
+        using namespace std::chrono_literals;
+        return !e.pins && e.context.wait_for(0s) == std::future_status::ready;
+    }
+
+    /// Evicts the least recently used unpinned entry matching the predicate
+    template <typename Pred>
+    bool evict_one(Pred&& pred)
+    {
+        auto victim{m_entries.end()};
+        for (auto it{m_entries.begin()}; it != m_entries.end(); ++it)
+        {
+            if (pred(*it) && evictable(*it) && (victim == m_entries.end() || it->last_used < victim->last_used))
+                victim = it;
+        }
+        if (victim == m_entries.end())
+            return false;
+        m_entries.erase(victim);
+        return true;
+    }
+
+    void evict_over_limits()
+    {
+        // Count limits, per kind and per NUMA node for full contexts
+        for (size_t i{0}; i < m_entries.size(); ++i)
+        {
+            const context_key group{m_entries[i].key};
+            const unsigned limit{group.full ? m_limits.max_full_contexts : m_limits.max_light_contexts};
+            auto in_group = [&group](const entry& e) {
+                return e.key.full == group.full && e.key.numa_node == group.numa_node;
+            };
+            while (static_cast<size_t>(std::count_if(m_entries.begin(), m_entries.end(), in_group)) > limit)
+            {
+                if (!evict_one(in_group))
+                    break;
+            }
+        }
+
+        // Memory budget
+        while (m_limits.memory_budget)
+        {
+            size_t total{0};
+            for (const auto& e : m_entries)
+                total += e.memory_size;
+            if (total <= m_limits.memory_budget || !evict_one([](const entry&) { return true; }))
+                break;
+        }
+    }
+
+    std::mutex m_mutex;
+    std::vector<entry> m_entries;
+    epoch_manager_limits m_limits;
+    uint64_t m_tick{0};
+};
+
+}  // namespace
+
+void set_epoch_manager_limits(const epoch_manager_limits& limits)
+{
+    epoch_context_manager::instance().set_limits(limits);
+}
+
+size_t get_epoch_manager_memory() noexcept
+{
+    return epoch_context_manager::instance().memory();
+}
+
+std::shared_ptr<epoch_context> get_epoch_context(uint32_t epoch_number, bool full) noexcept
+{
+    try
+    {
+        return epoch_context_manager::instance().acquire({epoch_number, full, -1});
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+epoch_context_future get_epoch_context_async(uint32_t epoch_number, bool full, epoch_context_ready_fn on_ready)
+{
+    auto promise{std::make_shared<std::promise<std::shared_ptr<epoch_context>>>()};
+    epoch_context_future future{promise->get_future().share()};
+
+    // Detached: the caller may drop the future, the build still completes and the
+    // context stays resident for the next acquirer
+    std::thread([epoch_number, full, promise, on_ready]() {
+        std::shared_ptr<epoch_context> context;
+        try
+        {
+            context = epoch_context_manager::instance().acquire({epoch_number, full, -1});
+            promise->set_value(context);
+        }
+        catch (...)
+        {
+            promise->set_exception(std::current_exception());
+        }
+        if (on_ready)
+            on_ready(context);
+    }).detach();
+    return future;
+}
+
+std::shared_ptr<epoch_context> get_numa_epoch_context(uint32_t epoch_number, unsigned numa_node) noexcept
+{
+    try
+    {
+        return epoch_context_manager::instance().acquire({epoch_number, true, static_cast<int>(numa_node)});
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+}  // namespace ethash
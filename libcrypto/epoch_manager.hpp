@@ -0,0 +1,42 @@
+// firominer: process wide manager of resident ethash epoch contexts.
+// Licensed under the Apache License, Version 2.0.
+
+// Written by Firominer's authors 2021
+
+#pragma once
+#ifndef CRYPTO_EPOCH_MANAGER_HPP_
+#define CRYPTO_EPOCH_MANAGER_HPP_
+
+#include <cstddef>
+
+namespace ethash
+{
+/**
+ * Bounds of the contexts kept resident by the epoch context manager, which backs
+ * get_epoch_context() and get_numa_epoch_context().
+ *
+ * Contexts stay resident after their last pin is released so switching back
+ * and forth between epochs is cheap. Over the limits the least recently used
+ * unpinned ones are evicted. Pinned contexts are never evicted, thus the limits
+ * may be exceeded while more contexts than allowed are in use.
+ */
+struct epoch_manager_limits
+{
+    unsigned max_light_contexts{2};  // Light contexts (current and previous epoch)
+    unsigned max_full_contexts{1};   // Full contexts, per NUMA node
+    size_t memory_budget{0};         // Bytes of all contexts. 0 means no budget
+};
+
+/**
+ * Sets the limits and evicts whatever is now over them
+ */
+void set_epoch_manager_limits(const epoch_manager_limits& limits);
+
+/**
+ * Returns the number of bytes of all contexts resident or being built
+ */
+size_t get_epoch_manager_memory() noexcept;
+
+}  // namespace ethash
+
+#endif  // !CRYPTO_EPOCH_MANAGER_HPP_
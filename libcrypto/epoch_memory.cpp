@@ -0,0 +1,201 @@
+// firominer: page backed memory for ethash epoch contexts.
+// Licensed under the Apache License, Version 2.0.
+
+// Written by Firominer's authors 2021
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/mman.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#define HAVE_EPOCH_MMAP 1
+#else
+#define HAVE_EPOCH_MMAP 0
+#endif
+
+#include "epoch_memory.hpp"
+
+namespace ethash
+{
+namespace
+{
+#if HAVE_EPOCH_MMAP
+constexpr size_t kHuge_2mb = size_t{1} << 21;
+constexpr size_t kHuge_1gb = size_t{1} << 30;
+
+size_t round_up(size_t size, size_t alignment) noexcept
+{
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+/// The length actually mapped for a block of the given size and page type
+size_t mapped_size(size_t size, page_type type) noexcept
+{
+    switch (type)
+    {
+    case page_type::huge_1gb:
+        return round_up(size, kHuge_1gb);
+    case page_type::huge_2mb:
+    case page_type::transparent:
+        return round_up(size, kHuge_2mb);
+    default:
+        return size;
+    }
+}
+
+void* map_anonymous(size_t size, int extra_flags) noexcept
+{
+    void* const data{::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0)};
+    return data == MAP_FAILED ? nullptr : data;
+}
+
+/// madvise() succeeds even when transparent huge pages are turned off, so check the policy
+bool transparent_huge_pages_enabled()
+{
+#if defined(__linux__)
+    std::ifstream policy{"/sys/kernel/mm/transparent_hugepage/enabled"};
+    std::string line;
+    return std::getline(policy, line) && line.find("[never]") == std::string::npos;
+#else
+    return false;
+#endif
+}
+
+/// Sets a preferred node policy on the range with a raw mbind() so we don't
+/// depend on libnuma. Best effort, the kernel may not be NUMA enabled.
+void bind_to_node(void* data, size_t size, int numa_node) noexcept
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    static constexpr int mpol_preferred{1};
+    static constexpr size_t word_bits{sizeof(unsigned long) * 8};
+    static constexpr size_t mask_words{16};
+    static constexpr size_t mask_bits{mask_words * word_bits};
+    if (numa_node < 0 || static_cast<size_t>(numa_node) >= mask_bits - 1)
+        return;
+
+    unsigned long mask[mask_words]{};
+    mask[numa_node / word_bits] = 1ul << (numa_node % word_bits);
+    ::syscall(SYS_mbind, data, size, mpol_preferred, mask, mask_bits, 0);
+#else
+    (void)data;
+    (void)size;
+    (void)numa_node;
+#endif
+}
+
+void* allocate_pages(size_t size, page_type& type) noexcept
+{
+#if defined(MAP_HUGETLB)
+    // Explicit huge pages, only available if the admin reserved a pool for them.
+    // 1 GiB pages are only worth it for a full dataset.
+#if defined(MAP_HUGE_1GB)
+    if (size >= kHuge_1gb)
+    {
+        if (void* data = map_anonymous(round_up(size, kHuge_1gb), MAP_HUGETLB | MAP_HUGE_1GB))
+        {
+            type = page_type::huge_1gb;
+            return data;
+        }
+    }
+#endif
+    if (size >= kHuge_2mb)
+    {
+#if defined(MAP_HUGE_2MB)
+        const int flags{MAP_HUGETLB | MAP_HUGE_2MB};
+#else
+        const int flags{MAP_HUGETLB};
+#endif
+        if (void* data = map_anonymous(round_up(size, kHuge_2mb), flags))
+        {
+            type = page_type::huge_2mb;
+            return data;
+        }
+    }
+#endif
+
+#if defined(MADV_HUGEPAGE)
+    // Transparent huge pages. Over-allocate to hand out a 2 MiB aligned block
+    // so the kernel can back all of it with huge pages, then trim the excess.
+    if (size >= kHuge_2mb && transparent_huge_pages_enabled())
+    {
+        const size_t aligned_size{round_up(size, kHuge_2mb)};
+        const size_t over_size{aligned_size + kHuge_2mb};
+        if (auto* mapped = static_cast<char*>(map_anonymous(over_size, 0)))
+        {
+            auto* const data{reinterpret_cast<char*>(round_up(reinterpret_cast<uintptr_t>(mapped), kHuge_2mb))};
+            const size_t head{static_cast<size_t>(data - mapped)};
+            const size_t tail{over_size - head - aligned_size};
+            if (head)
+                ::munmap(mapped, head);
+            if (tail)
+                ::munmap(data + aligned_size, tail);
+
+            if (::madvise(data, aligned_size, MADV_HUGEPAGE) == 0)
+            {
+                type = page_type::transparent;
+                return data;
+            }
+            ::munmap(data, aligned_size);
+        }
+    }
+#endif
+
+    type = page_type::normal;
+    return map_anonymous(size, 0);
+}
+#endif
+
+}  // namespace
+
+std::string to_string(page_type type)
+{
+    switch (type)
+    {
+    case page_type::transparent:
+        return "transparent huge";
+    case page_type::huge_2mb:
+        return "2 MiB huge";
+    case page_type::huge_1gb:
+        return "1 GiB huge";
+    default:
+        return "normal";
+    }
+}
+
+namespace detail
+{
+void* allocate_epoch_memory(size_t size, page_type& type, int numa_node) noexcept
+{
+#if HAVE_EPOCH_MMAP
+    void* const data{allocate_pages(size, type)};
+
+    // Nothing has touched the pages yet so the policy decides where all of them go
+    if (data && numa_node >= 0)
+        bind_to_node(data, mapped_size(size, type), numa_node);
+    return data;
+#else
+    (void)numa_node;
+    type = page_type::normal;
+    return std::calloc(1, size);
+#endif
+}
+
+void free_epoch_memory(void* data, size_t size, page_type type) noexcept
+{
+#if HAVE_EPOCH_MMAP
+    ::munmap(data, mapped_size(size, type));
+#else
+    (void)size;
+    (void)type;
+    std::free(data);
+#endif
+}
+
+}  // namespace detail
+
+}  // namespace ethash
@@ -0,0 +1,57 @@
+// firominer: page backed memory for ethash epoch contexts.
+// Licensed under the Apache License, Version 2.0.
+
+// Written by Firominer's authors 2021
+
+#pragma once
+#ifndef CRYPTO_EPOCH_MEMORY_HPP_
+#define CRYPTO_EPOCH_MEMORY_HPP_
+
+#include <cstddef>
+#include <string>
+
+namespace ethash
+{
+/**
+ * Kind of pages backing an epoch context. Light cache and dataset reads are random
+ * so the larger the pages the fewer TLB misses.
+ *
+ * normal           Base pages (4 KiB on x86)
+ * transparent      Base pages advised to the kernel for transparent huge pages
+ * huge_2mb         Explicit 2 MiB huge pages (hugetlbfs pool)
+ * huge_1gb         Explicit 1 GiB huge pages (hugetlbfs pool)
+ */
+enum class page_type
+{
+    normal,
+    transparent,
+    huge_2mb,
+    huge_1gb
+};
+
+std::string to_string(page_type type);
+
+namespace detail
+{
+/**
+ * Allocates zeroed memory, trying in order explicit huge pages, transparent huge
+ * pages, then normal pages.
+ *
+ * @param size      The number of bytes
+ * @param type      Receives the kind of pages actually used
+ * @param numa_node The NUMA node the pages are preferably taken from, whatever
+ *                  thread touches them first. Negative means no preference
+ * @return          The memory or nullptr if out of memory
+ */
+void* allocate_epoch_memory(size_t size, page_type& type, int numa_node = -1) noexcept;
+
+/**
+ * Releases memory obtained from allocate_epoch_memory()
+ */
+void free_epoch_memory(void* data, size_t size, page_type type) noexcept;
+
+}  // namespace detail
+
+}  // namespace ethash
+
+#endif  // !CRYPTO_EPOCH_MEMORY_HPP_
@@ -0,0 +1,537 @@
+// firominer: precomputed ethash epoch sizes.
+// Licensed under the Apache License, Version 2.0.
+
+// Written by Firominer's authors 2021
+
+// Generated by running the prime searches of calculate_light_cache_num_items() and
+// calculate_full_dataset_num_items() for every epoch. Must be regenerated whenever
+// kLight_cache_* or kFull_dataset_* constants change.
+
+#include "epoch_sizes.hpp"
+
+namespace ethash
+{
+namespace detail
+{
+// clang-format off
+const uint32_t light_cache_num_items_table[kEpoch_sizes_count] = {
+    262139, 264179, 266239, 268283, 270329, 272383, 274423, 276467,
+    278503, 280561, 282617, 284659, 286711, 288767, 290803, 292849,
+    294911, 296941, 298999, 301051, 303097, 305147, 307189, 309241,
+    311293, 313343, 315389, 317437, 319483, 321509, 323581, 325631,
+    327673, 329723, 331769, 333821, 335857, 337919, 339959, 341993,
+    344053, 346111, 348149, 350191, 352249, 354301, 356351, 358373,
+    360439, 362473, 364543, 366547, 368633, 370687, 372733, 374783,
+    376823, 378869, 380917, 382961, 385013, 387071, 389117, 391163,
+    393209, 395261, 397303, 399353, 401407, 403439, 405499, 407527,
+    409597, 411641, 413689, 415729, 417773, 419831, 421847, 423931,
+    425977, 428027, 430061, 432121, 434167, 436217, 438271, 440311,
+    442367, 444403, 446461, 448451, 450557, 452597, 454637, 456697,
+    458747, 460793, 462841, 464879, 466919, 468983, 471007, 473027,
+    475109, 477163, 479231, 481249, 483323, 485371, 487423, 489457,
+    491503, 493567, 495613, 497663, 499711, 501731, 503803, 505823,
+    507901, 509947, 511997, 514021, 516091, 518137, 520151, 522239,
+    524287, 526307, 528383, 530429, 532453, 534511, 536563, 538621,
+    540629, 542719, 544759, 546781, 548861, 550909, 552917, 554977,
+    557041, 559099, 561109, 563197, 565247, 567277, 569323, 571381,
+    573437, 575479, 577531, 579583, 581617, 583673, 585727, 587773,
+    589811, 591863, 593903, 595967, 598007, 600053, 602111, 604073,
+    606181, 608213, 610301, 612349, 614387, 616439, 618463, 620531,
+    622577, 624607, 626687, 628721, 630737, 632813, 634871, 636919,
+    638971, 640993, 643061, 645097, 647161, 649183, 651257, 653311,
+    655357, 657403, 659453, 661483, 663547, 665591, 667643, 669689,
+    671743, 673787, 675839, 677857, 679933, 681983, 684017, 686057,
+    688111, 690163, 692221, 694271, 696317, 698359, 700393, 702451,
+    704507, 706547, 708601, 710641, 712697, 714751, 716789, 718847,
+    720887, 722933, 724991, 727021, 729073, 731117, 733177, 735211,
+    737279, 739327, 741373, 743423, 745471, 747499, 749557, 751613,
+    753659, 755707, 757753, 759799, 761833, 763901, 765949, 767957,
+    770047, 772091, 774143, 776183, 778237, 780287, 782329, 784379,
+    786431, 788479, 790523, 792563, 794593, 796657, 798713, 800759,
+    802811, 804857, 806903, 808957, 810989, 813049, 815063, 817151,
+    819187, 821209, 823283, 825343, 827389, 829399, 831461, 833509,
+    835559, 837631, 839669, 841727, 843763, 845809, 847871, 849917,
+    851957, 853999, 856061, 858103, 860143, 862207, 864251, 866293,
+    868349, 870391, 872441, 874487, 876529, 878573, 880603, 882659,
+    884717, 886777, 888827, 890867, 892919, 894973, 897019, 899069,
+    901111, 903163, 905213, 907259, 909301, 911359, 913397, 915451,
+    917503, 919531, 921589, 923641, 925679, 927743, 929791, 931837,
+    933883, 935903, 937969, 940031, 942079, 944123, 946163, 948187,
+    950269, 952313, 954367, 956401, 958459, 960499, 962543, 964589,
+    966653, 968699, 970747, 972799, 974837, 976883, 978931, 980963,
+    982981, 985079, 987127, 989173, 991229, 993269, 995327, 997369,
+    999389, 1001467, 1003517, 1005553, 1007609, 1009651, 1011697, 1013741,
+    1015769, 1017851, 1019903, 1021919, 1023991, 1026043, 1028089, 1030121,
+    1032191, 1034239, 1036271, 1038329, 1040381, 1042427, 1044479, 1046527,
+    1048573, 1050611, 1052663, 1054717, 1056739, 1058809, 1060861, 1062911,
+    1064957, 1066999, 1069051, 1071067, 1073147, 1075187, 1077233, 1079291,
+    1081337, 1083391, 1085431, 1087487, 1089523, 1091581, 1093591, 1095671,
+    1097717, 1099771, 1101811, 1103863, 1105919, 1107937, 1110013, 1112057,
+    1114111, 1116133, 1118203, 1120237, 1122287, 1124351, 1126399, 1128433,
+    1130471, 1132541, 1134587, 1136633, 1138681, 1140721, 1142783, 1144823,
+    1146877, 1148921, 1150973, 1153021, 1155071, 1157111, 1159153, 1161203,
+    1163263, 1165303, 1167359, 1169401, 1171451, 1173481, 1175521, 1177571,
+    1179641, 1181681, 1183739, 1185791, 1187839, 1189879, 1191923, 1193971,
+    1196029, 1198073, 1200109, 1202153, 1204219, 1206263, 1208303, 1210351,
+    1212401, 1214459, 1216507, 1218559, 1220599, 1222651, 1224703, 1226741,
+    1228789, 1230829, 1232893, 1234901, 1236979, 1239023, 1241087, 1243133,
+    1245169, 1247231, 1249273, 1251323, 1253347, 1255421, 1257463, 1259509,
+    1261567, 1263607, 1265657, 1267711, 1269757, 1271807, 1273843, 1275899,
+    1277911, 1279997, 1282033, 1284083, 1286119, 1288187, 1290209, 1292281,
+    1294309, 1296371, 1298387, 1300477, 1302493, 1304551, 1306601, 1308649,
+    1310719, 1312739, 1314809, 1316831, 1318903, 1320947, 1323001, 1325047,
+    1327099, 1329143, 1331153, 1333231, 1335289, 1337333, 1339391, 1341437,
+    1343479, 1345507, 1347569, 1349533, 1351667, 1353713, 1355771, 1357823,
+    1359871, 1361911, 1363963, 1366009, 1368053, 1370111, 1372139, 1374187,
+    1376237, 1378301, 1380341, 1382393, 1384433, 1386491, 1388483, 1390573,
+    1392631, 1394683, 1396723, 1398781, 1400821, 1402873, 1404919, 1406959,
+    1409017, 1411061, 1413107, 1415143, 1417189, 1419263, 1421309, 1423339,
+    1425371, 1427453, 1429481, 1431539, 1433591, 1435631, 1437691, 1439743,
+    1441771, 1443839, 1445887, 1447913, 1449983, 1451969, 1454071, 1456127,
+    1458169, 1460213, 1462249, 1464299, 1466329, 1468403, 1470461, 1472507,
+    1474559, 1476581, 1478639, 1480691, 1482743, 1484741, 1486847, 1488871,
+    1490941, 1492969, 1495019, 1497061, 1499123, 1501177, 1503181, 1505279,
+    1507321, 1509371, 1511423, 1513453, 1515509, 1517567, 1519607, 1521649,
+    1523707, 1525747, 1527803, 1529851, 1531897, 1533947, 1535987, 1538039,
+    1540087, 1542137, 1544177, 1546231, 1548277, 1550327, 1552381, 1554419,
+    1556473, 1558523, 1560569, 1562611, 1564657, 1566673, 1568767, 1570781,
+    1572853, 1574873, 1576957, 1579001, 1581053, 1583093, 1585147, 1587197,
+    1589239, 1591277, 1593341, 1595389, 1597433, 1599469, 1601533, 1603573,
+    1605631, 1607663, 1609717, 1611773, 1613813, 1615871, 1617893, 1619957,
+    1622009, 1624057, 1626109, 1628153, 1630199, 1632227, 1634293, 1636343,
+    1638353, 1640447, 1642483, 1644497, 1646581, 1648613, 1650673, 1652731,
+    1654739, 1656829, 1658873, 1660921, 1662961, 1665023, 1667053, 1669103,
+    1671161, 1673209, 1675259, 1677287, 1679351, 1681403, 1683433, 1685503,
+    1687549, 1689553, 1691647, 1693691, 1695737, 1697771, 1699837, 1701881,
+    1703903, 1705973, 1708009, 1710077, 1712077, 1714171, 1716217, 1718267,
+    1720307, 1722359, 1724413, 1726453, 1728511, 1730551, 1732597, 1734647,
+    1736701, 1738739, 1740793, 1742843, 1744891, 1746929, 1748963, 1751039,
+    1753069, 1755133, 1757153, 1759231, 1761187, 1763323, 1765369, 1767421,
+    1769441, 1771507, 1773523, 1775611, 1777661, 1779709, 1781743, 1783801,
+    1785853, 1787899, 1789951, 1791991, 1794041, 1796071, 1798133, 1800191,
+    1802239, 1804273, 1806331, 1808377, 1810423, 1812457, 1814509, 1816567,
+    1818617, 1820671, 1822703, 1824761, 1826807, 1828847, 1830911, 1832947,
+    1835003, 1837027, 1839091, 1841141, 1843189, 1845229, 1847281, 1849333,
+    1851391, 1853399, 1855463, 1857533, 1859569, 1861631, 1863677, 1865719,
+    1867771, 1869823, 1871851, 1873889, 1875959, 1878013, 1880027, 1882099,
+    1884133, 1886197, 1888253, 1890299, 1892329, 1894397, 1896443, 1898483,
+    1900543, 1902569, 1904621, 1906673, 1908713, 1910767, 1912831, 1914853,
+    1916921, 1918967, 1921021, 1923059, 1925117, 1927157, 1929199, 1931261,
+    1933301, 1935343, 1937401, 1939447, 1941503, 1943537, 1945597, 1947641,
+    1949657, 1951739, 1953767, 1955839, 1957871, 1959889, 1961983, 1964009,
+    1966079, 1968103, 1970161, 1972207, 1974263, 1976309, 1978363, 1980413,
+    1982447, 1984511, 1986553, 1988599, 1990643, 1992691, 1994743, 1996793,
+    1998839, 2000863, 2002939, 2004991, 2007029, 2009083, 2011129, 2013181,
+    2015213, 2017247, 2019317, 2021339, 2023421, 2025467, 2027513, 2029567,
+    2031611, 2033657, 2035687, 2037757, 2039797, 2041849, 2043869, 2045929,
+    2047993, 2050033, 2052059, 2054131, 2056157, 2058239, 2060287, 2062303,
+    2064379, 2066419, 2068477, 2070527, 2072573, 2074609, 2076653, 2078719,
+    2080763, 2082803, 2084833, 2086907, 2088953, 2090989, 2093041, 2095099,
+    2097143, 2099197, 2101247, 2103239, 2105329, 2107381, 2109421, 2111471,
+    2113523, 2115571, 2117623, 2119673, 2121683, 2123773, 2125819, 2127857,
+    2129903, 2131951, 2134007, 2136061, 2138093, 2140157, 2142181, 2144251,
+    2146303, 2148347, 2150399, 2152433, 2154491, 2156537, 2158591, 2160629,
+    2162681, 2164681, 2166763, 2168827, 2170877, 2172917, 2174951, 2177011,
+    2179063, 2181097, 2183141, 2185201, 2187259, 2189309, 2191339, 2193383,
+    2195443, 2197501, 2199529, 2201599, 2203637, 2205667, 2207719, 2209789,
+    2211821, 2213867, 2215931, 2217967, 2220007, 2222071, 2224099, 2226163,
+    2228221, 2230253, 2232317, 2234341, 2236397, 2238421, 2240507, 2242549,
+    2244589, 2246641, 2248703, 2250713, 2252779, 2254831, 2256887, 2258917,
+    2260967, 2263007, 2265079, 2267131, 2269181, 2271229, 2273279, 2275327,
+    2277367, 2279423, 2281429, 2283511, 2285551, 2287613, 2289659, 2291699,
+    2293757, 2295803, 2297849, 2299901, 2301941, 2303999, 2306041, 2308079,
+    2310137, 2312179, 2314231, 2316287, 2318333, 2320363, 2322431, 2324471,
+    2326517, 2328569, 2330617, 2332667, 2334691, 2336743, 2338799, 2340859,
+    2342869, 2344943, 2347001, 2349041, 2351101, 2353129, 2355191, 2357231,
+    2359267, 2361343, 2363359, 2365439, 2367487, 2369527, 2371543, 2373611,
+    2375671, 2377721, 2379761, 2381807, 2383867, 2385919, 2387953, 2390009,
+    2392057, 2394109, 2396153, 2398189, 2400253, 2402297, 2404349, 2406379,
+    2408437, 2410483, 2412541, 2414591, 2416619, 2418683, 2420723, 2422781,
+    2424827, 2426873, 2428919, 2430947, 2433001, 2435053, 2437049, 2439167,
+    2441209, 2443241, 2445301, 2447359, 2449399, 2451443, 2453501, 2455547,
+    2457569, 2459623, 2461649, 2463707, 2465789, 2467783, 2469871, 2471927,
+    2473979, 2476013, 2478067, 2480119, 2482157, 2484203, 2486269, 2488319,
+    2490337, 2492393, 2494463, 2496503, 2498539, 2500601, 2502649, 2504693,
+    2506729, 2508797, 2510843, 2512847, 2514943, 2516981, 2519021, 2521081,
+    2523133, 2525179, 2527223, 2529269, 2531293, 2533373, 2535413, 2537467,
+    2539519, 2541563, 2543609, 2545657, 2547689, 2549759, 2551793, 2553853,
+    2555897, 2557937, 2559989, 2562031, 2564077, 2566141, 2568191, 2570233,
+    2572279, 2574323, 2576369, 2578423, 2580469, 2582501, 2584573, 2586611,
+    2588671, 2590717, 2592763, 2594807, 2596849, 2598907, 2600957, 2602993,
+    2605039, 2607097, 2609147, 2611199, 2613229, 2615287, 2617319, 2619391,
+    2621431, 2623487, 2625533, 2627563, 2629621, 2631679, 2633713, 2635757,
+    2637799, 2639869, 2641909, 2643961, 2646013, 2648057, 2650093, 2652157,
+    2654161, 2656243, 2658301, 2660351, 2662399, 2664443, 2666491, 2668469,
+    2670589, 2672639, 2674673, 2676731, 2678749, 2680831, 2682859, 2684923,
+    2686973, 2689019, 2691067, 2693113, 2695151, 2697209, 2699183, 2701301,
+    2703347, 2705383, 2707423, 2709491, 2711549, 2713589, 2715637, 2717683,
+    2719741, 2721773, 2723839, 2725871, 2727919, 2729983, 2732027, 2734027,
+    2736089, 2738167, 2740223, 2742263, 2744317, 2746339, 2748413, 2750453,
+    2752499, 2754551, 2756603, 2758633, 2760701, 2762741, 2764789, 2766821,
+    2768893, 2770939, 2772977, 2775011, 2777057, 2779129, 2781169, 2783227,
+    2785273, 2787307, 2789351, 2791409, 2793467, 2795501, 2797567, 2799607,
+    2801641, 2803699, 2805757, 2807789, 2809847, 2811883, 2813947, 2815997,
+    2818043, 2820089, 2822143, 2824189, 2826211, 2828281, 2830301, 2832383,
+    2834417, 2836447, 2838487, 2840549, 2842603, 2844649, 2846719, 2848753,
+    2850811, 2852849, 2854903, 2856923, 2859001, 2861051, 2863079, 2865131,
+    2867107, 2869241, 2871293, 2873341, 2875387, 2877419, 2879479, 2881531,
+    2883577, 2885627, 2887669, 2889707, 2891761, 2893811, 2895869, 2897897,
+    2899943, 2901989, 2904061, 2906089, 2908151, 2910203, 2912243, 2914283,
+    2916343, 2918393, 2920427, 2922461, 2924533, 2926591, 2928581, 2930657,
+    2932711, 2934773, 2936831, 2938861, 2940911, 2942959, 2945021, 2947027,
+    2949119, 2951161, 2953207, 2955257, 2957267, 2959321, 2961377, 2963453,
+    2965499, 2967551, 2969597, 2971607, 2973673, 2975741, 2977781, 2979833,
+    2981887, 2983927, 2985979, 2988023, 2990063, 2992123, 2994169, 2996219,
+    2998253, 3000317, 3002327, 3004409, 3006461, 3008477, 3010543, 3012593,
+    3014653, 3016697, 3018733, 3020789, 3022847, 3024881, 3026929, 3028973,
+    3031031, 3033073, 3035113, 3037183, 3039193, 3041279, 3043321, 3045323,
+    3047423, 3049469, 3051511, 3053563, 3055603, 3057661, 3059659, 3061759,
+    3063803, 3065849, 3067903, 3069949, 3071993, 3074047, 3076093, 3078137,
+    3080167, 3082231, 3084287, 3086311, 3088381, 3090431, 3092447, 3094523,
+    3096571, 3098597, 3100663, 3102713, 3104767, 3106787, 3108863, 3110903,
+    3112943, 3115003, 3117053, 3119089, 3121121, 3123187, 3125219, 3127291,
+    3129323, 3131377, 3133439, 3135487, 3137531, 3139583, 3141601, 3143671,
+    3145721, 3147773, 3149821, 3151871, 3153919, 3155963, 3157993, 3160063,
+    3162101, 3164143, 3166193, 3168247, 3170287, 3172349, 3174373, 3176447,
+    3178489, 3180523, 3182591, 3184639, 3186683, 3188723, 3190753, 3192829,
+    3194879, 3196927, 3198967, 3201007, 3203071, 3205087, 3207161, 3209201,
+    3211213, 3213283, 3215347, 3217399, 3219449, 3221503, 3223547, 3225539,
+    3227641, 3229691, 3231737, 3233779, 3235829, 3237869, 3239927, 3241981,
+    3244013, 3246079, 3248111, 3250157, 3252217, 3254269, 3256313, 3258349,
+    3260407, 3262451, 3264491, 3266551, 3268591, 3270653, 3272681, 3274729,
+    3276799, 3278837, 3280889, 3282913, 3284989, 3287033, 3289087, 3291109,
+    3293183, 3295223, 3297263, 3299323, 3301369, 3303409, 3305459, 3307489,
+    3309563, 3311603, 3313663, 3315701, 3317719, 3319807, 3321841, 3323869,
+    3325943, 3327991, 3330013, 3332093, 3334141, 3336181, 3338213, 3340277,
+    3342331, 3344377, 3346417, 3348479, 3350527, 3352571, 3354613, 3356657,
+    3358703, 3360767, 3362809, 3364853, 3366911, 3368957, 3370993, 3373043,
+    3375083, 3377141, 3379177, 3381239, 3383293, 3385339, 3387353, 3389437,
+    3391477, 3393487, 3395573, 3397627, 3399673, 3401711, 3403733, 3405823,
+    3407857, 3409891, 3411949, 3414013, 3416059, 3418111, 3420139, 3422207,
+    3424249, 3426277, 3428329, 3430391, 3432437, 3434489, 3436541, 3438583,
+    3440627, 3442679, 3444713, 3446761, 3448831, 3450871, 3452923, 3454967,
+    3457019, 3459037, 3461099, 3463157, 3465199, 3467263, 3469247, 3471359,
+    3473399, 3475453, 3477499, 3479537, 3481573, 3483643, 3485687, 3487709,
+    3489781, 3491827, 3493883, 3495917, 3497959, 3500023, 3502073, 3504107,
+    3506171, 3508201, 3510271, 3512317, 3514367, 3516413, 3518461, 3520511,
+    3522559, 3524603, 3526637, 3528659, 3530731, 3532769, 3534841, 3536881,
+    3538933, 3540991, 3543037, 3545083, 3547111, 3549179, 3551227, 3553273,
+    3555311, 3557339, 3559421, 3561443, 3563519, 3565567, 3567601, 3569653,
+    3571699, 3573751, 3575783, 3577829, 3579893, 3581927, 3583999, 3586021,
+    3588077, 3590143, 3592109, 3594223, 3596287, 3598319, 3600383, 3602393,
+    3604451, 3606511, 3608569, 3610619, 3612671, 3614719, 3616757, 3618809,
+    3620843, 3622909, 3624949, 3626989, 3629053, 3631073, 3633151, 3635197,
+    3637223, 3639289, 3641311, 3643369, 3645419, 3647477, 3649531, 3651559,
+    3653603, 3655667, 3657691, 3659717, 3661781, 3663833, 3665911, 3667967,
+    3670013, 3672059, 3674101, 3676157, 3678179, 3680249, 3682303, 3684337,
+    3686387, 3688393, 3690473, 3692543, 3694583, 3696619, 3698683, 3700727,
+    3702757, 3704821, 3706861, 3708923, 3710963, 3712981, 3715069, 3717113,
+    3719167, 3721213, 3723233, 3725303, 3727313, 3729391, 3731447, 3733463,
+    3735547, 3737599, 3739613, 3741671, 3743737, 3745789, 3747833, 3749881,
+    3751919, 3753979, 3756029, 3758077, 3760123, 3762173, 3764213, 3766261,
+    3768311, 3770357, 3772397, 3774457, 3776503, 3778531, 3780607, 3782629,
+    3784691, 3786751, 3788779, 3790807, 3792889, 3794941, 3796963, 3799039,
+    3801073, 3803131, 3805183, 3807229, 3809279, 3811321, 3813353, 3815423,
+    3817447, 3819511, 3821563, 3823609, 3825649, 3827701, 3829757, 3831781,
+    3833833, 3835903, 3837949, 3839999, 3842029, 3844079, 3846133, 3848191,
+    3850237, 3852271, 3854311, 3856381, 3858431, 3860471, 3862493, 3864557,
+    3866623, 3868649, 3870719, 3872767, 3874807, 3876827, 3878899, 3880949,
+    3883001, 3885047, 3887083, 3889079, 3891197, 3893243, 3895291, 3897331,
+    3899383, 3901439, 3903481, 3905533, 3907583, 3909617, 3911653, 3913727,
+    3915761, 3917801, 3919859, 3921919, 3923963, 3925993, 3928049, 3930061,
+    3932153, 3934207, 3936241, 3938303, 3940351, 3942397, 3944441, 3946493,
+    3948541, 3950563, 3952633, 3954683, 3956681, 3958777, 3960829, 3962867,
+    3964913, 3966961, 3969019, 3971063, 3973117, 3975163, 3977209, 3979259,
+    3981301, 3983341, 3985403, 3987449, 3989477, 3991543, 3993593, 3995647,
+    3997673, 3999739, 4001791, 4003819, 4005847, 4007933, 4009939, 4012013,
+    4014071, 4016119, 4018159, 4020223, 4022257, 4024309, 4026359, 4028413,
+    4030463, 4032493, 4034549, 4036601, 4038647, 4040683, 4042729, 4044797,
+    4046821, 4048871, 4050941, 4052989, 4055033, 4057061, 4059131, 4061177,
+    4063217, 4065241, 4067321, 4069349, 4071421, 4073453, 4075507, 4077559,
+    4079573, 4081661, 4083701, 4085749, 4087807, 4089853, 4091873, 4093937,
+    4095991, 4098043, 4100069, 4102141, 4104187, 4106239, 4108261, 4110331,
+    4112371, 4114421, 4116479, 4118519, 4120573, 4122623, 4124671, 4126697,
+    4128767, 4130807, 4132831, 4134887, 4136939, 4138999, 4141009, 4143101,
+    4145117, 4147163, 4149227, 4151269, 4153333, 4155367, 4157437, 4159471,
+    4161527, 4163563, 4165631, 4167673, 4169723, 4171771, 4173817, 4175869,
+    4177913, 4179953, 4182011, 4184027, 4186103, 4188133, 4190189, 4192231,
+    4194301, 4196347, 4198379, 4200439, 4202489, 4204537, 4206583, 4208629,
+    4210667, 4212731, 4214779, 4216819, 4218869, 4220927, 4222973, 4225019,
+    4227061, 4229119, 4231121, 4233199, 4235263, 4237283, 4239331, 4241399,
+    4243453, 4245499, 4247549, 4249579, 4251647, 4253693, 4255739, 4257787,
+    4259837, 4261867, 4263929, 4265981, 4268029, 4270073, 4272119, 4274173,
+    4276213, 4278257, 4280267, 4282367, 4284389, 4286453, 4288489, 4290553,
+    4292597, 4294649, 4296703, 4298729, 4300789, 4302847, 4304891, 4306937,
+    4308989, 4311037, 4313081, 4315123, 4317151, 4319209, 4321259, 4323323,
+    4325359, 4327423, 4329463, 4331513, 4333547, 4335607, 4337651, 4339703,
+    4341697, 4343791, 4345849, 4347899, 4349927, 4351981, 4354027, 4356091,
+    4358143, 4360189, 4362233, 4364267, 4366309, 4368379, 4370407, 4372477,
+    4374527, 4376557, 4378609, 4380647, 4382713, 4384727, 4386803, 4388861,
+    4390909, 4392937, 4394983, 4397053, 4399103, 4401143, 4403183, 4405243,
+    4407289, 4409333, 4411391, 4413419, 4415473, 4417513, 4419581, 4421621,
+    4423673, 4425721, 4427771, 4429819, 4431871, 4433911, 4435961, 4438009,
+    4440049, 4442107, 4444159, 4446203, 4448239, 4450301, 4452347, 4454399,
+};
+
+const uint32_t full_dataset_num_items_table[kEpoch_sizes_count] = {
+    12582893, 12648439, 12713959, 12779483, 12845033, 12910591, 12976121, 13041661,
+    13107197, 13172729, 13238263, 13303799, 13369333, 13434853, 13500373, 13565897,
+    13631477, 13697023, 13762549, 13828093, 13893613, 13959163, 14024671, 14090239,
+    14155763, 14221309, 14286809, 14352367, 14417881, 14483437, 14548979, 14614507,
+    14680063, 14745559, 14811133, 14876657, 14942197, 15007723, 15073277, 15138793,
+    15204349, 15269869, 15335407, 15400951, 15466463, 15531977, 15597559, 15663083,
+    15728611, 15794171, 15859687, 15925241, 15990781, 16056317, 16121849, 16187359,
+    16252919, 16318459, 16383977, 16449529, 16515067, 16580587, 16646099, 16711661,
+    16777213, 16842751, 16908263, 16973767, 17039339, 17104891, 17170429, 17235961,
+    17301463, 17367029, 17432561, 17498111, 17563633, 17629123, 17694709, 17760251,
+    17825791, 17891299, 17956849, 18022399, 18087899, 18153431, 18219001, 18284533,
+    18350063, 18415597, 18481097, 18546617, 18612211, 18677723, 18743281, 18808831,
+    18874367, 18939901, 19005433, 19070971, 19136503, 19202041, 19267561, 19333103,
+    19398647, 19464173, 19529717, 19595249, 19660799, 19726331, 19791869, 19857371,
+    19922923, 19988477, 20054011, 20119543, 20185051, 20250577, 20316151, 20381689,
+    20447191, 20512747, 20578297, 20643809, 20709347, 20774909, 20840429, 20905979,
+    20971507, 21037021, 21102583, 21168113, 21233651, 21299167, 21364727, 21430259,
+    21495797, 21561341, 21626819, 21692387, 21757951, 21823453, 21889019, 21954547,
+    22020091, 22085621, 22151167, 22216673, 22282199, 22347769, 22413289, 22478803,
+    22544351, 22609919, 22675403, 22740961, 22806521, 22872053, 22937591, 23003131,
+    23068667, 23134201, 23199731, 23265247, 23330773, 23396339, 23461877, 23527409,
+    23592937, 23658493, 23724031, 23789561, 23855101, 23920607, 23986159, 24051683,
+    24117217, 24182773, 24248299, 24313853, 24379391, 24444881, 24510463, 24575977,
+    24641479, 24707071, 24772603, 24838127, 24903667, 24969193, 25034731, 25100287,
+    25165813, 25231351, 25296893, 25362431, 25427957, 25493483, 25559033, 25624567,
+    25690097, 25755619, 25821179, 25886719, 25952243, 26017759, 26083273, 26148853,
+    26214379, 26279899, 26345471, 26411003, 26476543, 26542067, 26607611, 26673149,
+    26738687, 26804203, 26869753, 26935267, 27000817, 27066359, 27131903, 27197413,
+    27262931, 27328507, 27394019, 27459581, 27525109, 27590653, 27656149, 27721721,
+    27787213, 27852791, 27918323, 27983863, 28049407, 28114943, 28180459, 28246003,
+    28311541, 28377077, 28442551, 28508153, 28573673, 28639231, 28704749, 28770293,
+    28835819, 28901311, 28966909, 29032441, 29097977, 29163481, 29229047, 29294581,
+    29360087, 29425637, 29491193, 29556719, 29622269, 29687783, 29753341, 29818871,
+    29884411, 29949943, 30015481, 30081019, 30146531, 30212093, 30277627, 30343129,
+    30408701, 30474239, 30539749, 30605303, 30670847, 30736379, 30801917, 30867439,
+    30932987, 30998509, 31064063, 31129597, 31195117, 31260653, 31326181, 31391729,
+    31457269, 31522747, 31588351, 31653871, 31719409, 31784941, 31850491, 31916011,
+    31981567, 32047097, 32112607, 32178169, 32243707, 32309243, 32374781, 32440319,
+    32505829, 32571373, 32636921, 32702443, 32767997, 32833531, 32899037, 32964559,
+    33030121, 33095677, 33161201, 33226741, 33292283, 33357811, 33423319, 33488891,
+    33554393, 33619919, 33685493, 33751019, 33816571, 33882103, 33947621, 34013183,
+    34078699, 34144207, 34209787, 34275301, 34340861, 34406399, 34471933, 34537427,
+    34602991, 34668527, 34734079, 34799563, 34865141, 34930619, 34996223, 35061751,
+    35127263, 35192831, 35258347, 35323903, 35389423, 35454943, 35520467, 35586017,
+    35651579, 35717111, 35782613, 35848187, 35913727, 35979257, 36044797, 36110311,
+    36175871, 36241397, 36306937, 36372463, 36438013, 36503531, 36569083, 36634621,
+    36700159, 36765683, 36831227, 36896767, 36962291, 37027831, 37093373, 37158911,
+    37224437, 37289957, 37355503, 37421053, 37486591, 37552091, 37617653, 37683199,
+    37748717, 37814267, 37879783, 37945339, 38010871, 38076407, 38141951, 38207479,
+    38273023, 38338541, 38404081, 38469617, 38535151, 38600701, 38666219, 38731769,
+    38797303, 38862797, 38928371, 38993917, 39059431, 39124991, 39190519, 39255967,
+    39321599, 39387067, 39452671, 39518201, 39583727, 39649277, 39714799, 39780343,
+    39845887, 39911423, 39976939, 40042469, 40108027, 40173557, 40239103, 40304633,
+    40370173, 40435699, 40501231, 40566749, 40632313, 40697851, 40763369, 40828927,
+    40894457, 40959979, 41025499, 41091047, 41156569, 41222143, 41287651, 41353201,
+    41418739, 41484271, 41549803, 41615347, 41680871, 41746423, 41811949, 41877499,
+    41943023, 42008567, 42074101, 42139619, 42205183, 42270707, 42336253, 42401773,
+    42467317, 42532859, 42598397, 42663917, 42729437, 42795007, 42860537, 42926069,
+    42991609, 43057151, 43122683, 43188203, 43253759, 43319293, 43384813, 43450357,
+    43515881, 43581437, 43646963, 43712447, 43778011, 43843537, 43909111, 43974613,
+    44040187, 44105689, 44171261, 44236799, 44302303, 44367833, 44433391, 44498941,
+    44564461, 44630011, 44695549, 44761069, 44826611, 44892143, 44957687, 45023203,
+    45088739, 45154283, 45219827, 45285371, 45350869, 45416411, 45481973, 45547517,
+    45613039, 45678559, 45744121, 45809657, 45875191, 45940711, 46006249, 46071769,
+    46137319, 46202867, 46268381, 46333943, 46399471, 46465019, 46530557, 46596089,
+    46661627, 46727143, 46792699, 46858211, 46923761, 46989281, 47054809, 47120377,
+    47185907, 47251447, 47316991, 47382527, 47448061, 47513563, 47579131, 47644669,
+    47710207, 47775697, 47841257, 47906797, 47972341, 48037883, 48103417, 48168943,
+    48234451, 48300029, 48365563, 48431063, 48496639, 48562127, 48627697, 48693223,
+    48758783, 48824299, 48889837, 48955373, 49020913, 49086451, 49151987, 49217527,
+    49283063, 49348601, 49414111, 49479653, 49545193, 49610741, 49676267, 49741807,
+    49807327, 49872887, 49938431, 50003939, 50069497, 50135027, 50200573, 50266087,
+    50331599, 50397167, 50462683, 50528227, 50593783, 50659321, 50724859, 50790391,
+    50855899, 50921461, 50987003, 51052543, 51118069, 51183599, 51249131, 51314677,
+    51380179, 51445747, 51511277, 51576829, 51642341, 51707893, 51773431, 51838949,
+    51904511, 51970033, 52035569, 52101109, 52166641, 52232183, 52297717, 52363231,
+    52428767, 52494329, 52559867, 52625407, 52690919, 52756453, 52821983, 52887533,
+    52953077, 53018621, 53084147, 53149673, 53215229, 53280763, 53346301, 53411767,
+    53477357, 53542901, 53608441, 53673979, 53739493, 53805049, 53870573, 53936111,
+    54001663, 54067163, 54132721, 54198259, 54263789, 54329291, 54394877, 54460381,
+    54525917, 54591479, 54656983, 54722557, 54788089, 54853583, 54919159, 54984679,
+    55050217, 55115773, 55181311, 55246837, 55312351, 55377911, 55443433, 55508983,
+    55574507, 55640063, 55705589, 55771091, 55836659, 55902181, 55967701, 56033203,
+    56098813, 56164349, 56229881, 56295397, 56360911, 56426483, 56491993, 56557559,
+    56623093, 56688637, 56754167, 56819699, 56885219, 56950741, 57016319, 57081811,
+    57147379, 57212921, 57278461, 57343981, 57409529, 57475069, 57540599, 57606139,
+    57671671, 57737209, 57802739, 57868273, 57933817, 57999341, 58064861, 58130393,
+    58195939, 58261501, 58327039, 58392571, 58458091, 58523623, 58589161, 58654711,
+    58720253, 58785781, 58851307, 58916863, 58982389, 59047927, 59113469, 59179007,
+    59244539, 59310079, 59375587, 59441147, 59506679, 59572223, 59637733, 59703289,
+    59768831, 59834329, 59899901, 59965429, 60030953, 60096481, 60162029, 60227581,
+    60293119, 60358637, 60424183, 60489713, 60555227, 60620761, 60686321, 60751861,
+    60817397, 60882929, 60948479, 61014001, 61079531, 61145087, 61210603, 61276151,
+    61341659, 61407223, 61472753, 61538297, 61603811, 61669373, 61734899, 61800437,
+    61865971, 61931491, 61997053, 62062573, 62128127, 62193641, 62259193, 62324729,
+    62390261, 62455781, 62521331, 62586871, 62652407, 62717939, 62783477, 62849021,
+    62914549, 62980069, 63045613, 63111151, 63176693, 63242239, 63307763, 63373309,
+    63438839, 63504377, 63569917, 63635443, 63700991, 63766523, 63832057, 63897593,
+    63963131, 64028669, 64094207, 64159723, 64225267, 64290799, 64356349, 64421881,
+    64487417, 64552931, 64618493, 64684013, 64749563, 64815103, 64880587, 64946159,
+    65011703, 65077231, 65142769, 65208307, 65273851, 65339387, 65404909, 65470453,
+    65535989, 65601533, 65667067, 65732599, 65798137, 65863667, 65929211, 65994739,
+    66060277, 66125819, 66191351, 66256891, 66322427, 66387967, 66453479, 66519023,
+    66584561, 66650069, 66715643, 66781177, 66846709, 66912253, 66977767, 67043303,
+    67108859, 67174397, 67239883, 67305463, 67370999, 67436539, 67502063, 67567609,
+    67633127, 67698677, 67764223, 67829759, 67895251, 67960759, 68026363, 68091901,
+    68157433, 68222969, 68288503, 68354029, 68419567, 68485073, 68550631, 68616187,
+    68681719, 68747233, 68812769, 68878331, 68943851, 69009371, 69074933, 69140441,
+    69205987, 69271541, 69337087, 69402601, 69468151, 69533647, 69599221, 69664753,
+    69730303, 69795839, 69861331, 69926911, 69992443, 70057973, 70123513, 70189043,
+    70254563, 70320127, 70385641, 70451191, 70516729, 70582271, 70647793, 70713343,
+    70778861, 70844413, 70909933, 70975483, 71041021, 71106551, 71172091, 71237629,
+    71303153, 71368657, 71434229, 71499763, 71565283, 71630837, 71696363, 71761919,
+    71827423, 71892991, 71958521, 72024059, 72089573, 72155113, 72220663, 72286199,
+    72351733, 72417277, 72482807, 72548351, 72613861, 72679421, 72744937, 72810469,
+    72876031, 72941537, 73007089, 73072631, 73138171, 73203709, 73269247, 73334761,
+    73400311, 73465853, 73531379, 73596917, 73662461, 73727981, 73793521, 73859069,
+    73924583, 73990141, 74055637, 74121211, 74186747, 74252263, 74317801, 74383343,
+    74448877, 74514403, 74579951, 74645479, 74711027, 74776553, 74842099, 74907643,
+    74973181, 75038707, 75104243, 75169789, 75235327, 75300847, 75366397, 75431903,
+    75497467, 75562979, 75628513, 75694063, 75759613, 75825137, 75890653, 75956203,
+    76021661, 76087283, 76152821, 76218323, 76283897, 76349423, 76414973, 76480499,
+    76546039, 76611583, 76677113, 76742629, 76808119, 76873703, 76939253, 77004793,
+    77070317, 77135869, 77201347, 77266897, 77332471, 77397973, 77463541, 77529071,
+    77594599, 77660129, 77725691, 77791223, 77856767, 77922253, 77987821, 78053363,
+    78118903, 78184397, 78249973, 78315509, 78381047, 78446591, 78512101, 78577657,
+    78643199, 78708733, 78774259, 78839807, 78905303, 78970877, 79036411, 79101947,
+    79167479, 79233013, 79298543, 79364071, 79429619, 79495147, 79560673, 79626229,
+    79691761, 79757309, 79822829, 79888381, 79953901, 80019449, 80084969, 80150507,
+    80216063, 80281583, 80347103, 80412659, 80478199, 80543741, 80609279, 80674807,
+    80740339, 80805887, 80871419, 80936959, 81002489, 81068027, 81133567, 81199099,
+    81264587, 81330173, 81395683, 81461243, 81526763, 81592267, 81657841, 81723359,
+    81788923, 81854449, 81919993, 81985529, 82051043, 82116589, 82182137, 82247677,
+    82313213, 82378739, 82444279, 82509811, 82575331, 82640881, 82706431, 82771919,
+    82837501, 82903039, 82968563, 83034073, 83099641, 83165183, 83230717, 83296253,
+    83361781, 83427319, 83492863, 83558399, 83623931, 83689423, 83754997, 83820521,
+    83886053, 83951611, 84017117, 84082667, 84148213, 84213721, 84279277, 84344809,
+    84410353, 84475903, 84541421, 84606971, 84672487, 84738041, 84803581, 84869119,
+    84934621, 85000183, 85065719, 85131247, 85196789, 85262297, 85327849, 85393381,
+    85458929, 85524473, 85589989, 85655543, 85721081, 85786621, 85852147, 85917679,
+    85983217, 86048759, 86114279, 86179823, 86245343, 86310883, 86376443, 86441959,
+    86507507, 86572999, 86638577, 86704127, 86769647, 86835191, 86900731, 86966251,
+    87031759, 87097331, 87162857, 87228413, 87293939, 87359483, 87425021, 87490553,
+    87556087, 87621631, 87687167, 87752701, 87818239, 87883771, 87949307, 88014841,
+    88080359, 88145903, 88211449, 88276973, 88342519, 88408057, 88473569, 88539133,
+    88604653, 88670177, 88735721, 88801253, 88866797, 88932341, 88997827, 89063417,
+    89128939, 89194481, 89260027, 89325559, 89391103, 89456599, 89522171, 89587709,
+    89653217, 89718781, 89784313, 89849849, 89915383, 89980867, 90046441, 90111997,
+    90177533, 90243061, 90308599, 90374143, 90439667, 90505211, 90570751, 90636277,
+    90701797, 90767359, 90832871, 90898399, 90963967, 91029493, 91095013, 91160567,
+    91226101, 91291643, 91357177, 91422707, 91488251, 91553771, 91619321, 91684847,
+    91750391, 91815917, 91881443, 91947001, 92012537, 92078057, 92143609, 92209141,
+    92274671, 92340223, 92405723, 92471287, 92536823, 92602351, 92667863, 92733437,
+    92798969, 92864507, 92930039, 92995571, 93061117, 93126647, 93192191, 93257713,
+    93323249, 93388759, 93454307, 93519871, 93585379, 93650941, 93716471, 93781993,
+    93847549, 93913087, 93978559, 94044157, 94109681, 94175231, 94240733, 94306301,
+    94371833, 94437373, 94502899, 94568437, 94633963, 94699489, 94765039, 94830583,
+    94896119, 94961653, 95027197, 95092693, 95158249, 95223781, 95289329, 95354879,
+    95420401, 95485933, 95551487, 95617013, 95682541, 95748089, 95813621, 95879153,
+    95944691, 96010231, 96075739, 96141301, 96206839, 96272383, 96337919, 96403441,
+    96468979, 96534523, 96600041, 96665599, 96731101, 96796633, 96862169, 96927739,
+    96993269, 97058809, 97124347, 97189879, 97255409, 97320947, 97386467, 97452031,
+    97517543, 97583099, 97648637, 97714153, 97779701, 97845239, 97910759, 97976299,
+    98041831, 98107369, 98172887, 98238463, 98303999, 98369527, 98435063, 98500583,
+    98566121, 98631607, 98697187, 98762747, 98828281, 98893807, 98959337, 99024869,
+    99090427, 99155939, 99221489, 99287033, 99352567, 99418093, 99483647, 99549181,
+    99614689, 99680249, 99745787, 99811319, 99876851, 99942397, 100007927, 100073471,
+    100138979, 100204543, 100270069, 100335583, 100401139, 100466659, 100532207, 100597751,
+    100663291, 100728821, 100794319, 100859903, 100925431, 100990957, 101056507, 101122037,
+    101187577, 101253101, 101318647, 101384189, 101449717, 101515243, 101580793, 101646331,
+    101711839, 101777393, 101842931, 101908379, 101974009, 102039551, 102105049, 102170617,
+    102236149, 102301669, 102367189, 102432763, 102498301, 102563731, 102629369, 102694883,
+    102760387, 102825971, 102891499, 102957053, 103022537, 103088123, 103153649, 103219199,
+    103284733, 103350251, 103415791, 103481333, 103546879, 103612409, 103677949, 103743487,
+    103809011, 103874557, 103940093, 104005621, 104071157, 104136677, 104202233, 104267773,
+    104333311, 104398837, 104464369, 104529883, 104595397, 104660977, 104726527, 104792033,
+    104857589, 104923123, 104988641, 105054197, 105119741, 105185221, 105250811, 105316349,
+    105381841, 105447421, 105512951, 105578479, 105644029, 105709567, 105775079, 105840619,
+    105906167, 105971711, 106037237, 106102769, 106168319, 106233851, 106299379, 106364927,
+    106430449, 106495919, 106561523, 106627063, 106692601, 106758139, 106823677, 106889207,
+    106954747, 107020279, 107085799, 107151353, 107216891, 107282423, 107347943, 107413489,
+    107479033, 107544539, 107610079, 107675609, 107741167, 107806711, 107872249, 107937787,
+    108003323, 108068861, 108134393, 108199933, 108265459, 108331007, 108396521, 108462073,
+    108527603, 108593119, 108658681, 108724157, 108789727, 108855259, 108920831, 108986357,
+    109051903, 109117439, 109182947, 109248497, 109314043, 109379549, 109445107, 109510649,
+    109576189, 109641703, 109707253, 109772797, 109838293, 109903841, 109969403, 110034923,
+    110100409, 110166013, 110231531, 110297069, 110362559, 110428159, 110493661, 110559203,
+    110624753, 110690291, 110755793, 110821307, 110886883, 110952433, 111017983, 111083477,
+    111148963, 111214589, 111280121, 111345649, 111411173, 111476731, 111542261, 111607807,
+    111673343, 111738839, 111804389, 111869951, 111935459, 112001023, 112066553, 112132081,
+    112197629, 112263167, 112328683, 112394239, 112459751, 112525241, 112590839, 112656359,
+    112721893, 112787449, 112852981, 112918513, 112984061, 113049593, 113115133, 113180647,
+    113246183, 113311733, 113377279, 113442793, 113508319, 113573881, 113639419, 113704957,
+    113770457, 113836027, 113901553, 113967103, 114032599, 114098161, 114163703, 114229229,
+    114294721, 114360319, 114425807, 114491387, 114556913, 114622463, 114687977, 114753497,
+    114819031, 114884597, 114950131, 115015651, 115081189, 115146751, 115212287, 115277821,
+    115343341, 115408879, 115474417, 115539923, 115605467, 115671037, 115736539, 115802111,
+    115867627, 115933159, 115998719, 116064241, 116129789, 116195293, 116260849, 116326373,
+    116391917, 116457449, 116523007, 116588513, 116654077, 116719607, 116785133, 116850683,
+    116916223, 116981747, 117047291, 117112811, 117178367, 117243881, 117309421, 117374963,
+    117440509, 117506003, 117571523, 117637103, 117702649, 117768191, 117833711, 117899251,
+    117964793, 118030307, 118095853, 118161403, 118226893, 118292437, 118358003, 118423549,
+    118489081, 118554619, 118620143, 118685629, 118751207, 118816739, 118882279, 118947839,
+    119013347, 119078891, 119144447, 119209963, 119275511, 119341051, 119406587, 119472121,
+    119537653, 119603189, 119668723, 119734267, 119799803, 119865341, 119930873, 119996411,
+    120061951, 120127487, 120193019, 120258539, 120324077, 120389609, 120455147, 120520703,
+    120586231, 120651763, 120717307, 120782839, 120848353, 120913901, 120979447, 121044967,
+    121110523, 121176049, 121241597, 121307119, 121372649, 121438199, 121503737, 121569271,
+    121634801, 121700333, 121765871, 121831399, 121896949, 121962493, 122028019, 122093557,
+    122159101, 122224639, 122290171, 122355697, 122421241, 122486759, 122552317, 122617837,
+    122683391, 122748919, 122814463, 122879971, 122945527, 123011071, 123076601, 123142141,
+    123207677, 123273211, 123338737, 123404279, 123469783, 123535339, 123600857, 123666407,
+    123731963, 123797437, 123863023, 123928561, 123994099, 124059647, 124125161, 124190701,
+    124256243, 124321759, 124387321, 124452863, 124518397, 124583933, 124649449, 124714999,
+    124780531, 124846063, 124911601, 124977133, 125042663, 125108213, 125173759, 125239291,
+    125304787, 125370367, 125435897, 125501417, 125566963, 125632483, 125698021, 125763577,
+    125829103, 125894647, 125960189, 126025723, 126091241, 126156773, 126222293, 126287809,
+    126353407, 126418933, 126484469, 126550009, 126615551, 126681073, 126746623, 126812159,
+    126877693, 126943211, 127008733, 127074253, 127139833, 127205327, 127270849, 127336439,
+    127401947, 127467517, 127533047, 127598543, 127664113, 127729643, 127795181, 127860721,
+    127926263, 127991807, 128057327, 128122861, 128188409, 128253949, 128319469, 128385017,
+    128450533, 128516083, 128581631, 128647163, 128712691, 128778227, 128843761, 128909311,
+    128974841, 129040367, 129105901, 129171439, 129236959, 129302497, 129368051, 129433571,
+    129499129, 129564647, 129630199, 129695711, 129761273, 129826813, 129892333, 129957871,
+    130023407, 130088951, 130154483, 130220029, 130285567, 130351079, 130416631, 130482173,
+    130547621, 130613221, 130678781, 130744319, 130809853, 130875389, 130940911, 131006461,
+    131071987, 131137493, 131203069, 131268607, 131334131, 131399623, 131465177, 131530741,
+    131596279, 131661809, 131727359, 131792887, 131858413, 131923951, 131989477, 132055037,
+    132120557, 132186107, 132251621, 132317131, 132382717, 132448247, 132513781, 132579319,
+    132644851, 132710387, 132775931, 132841441, 132907007, 132972509, 133038053, 133103611,
+    133169137, 133234687, 133300207, 133365737, 133431293, 133496813, 133562329, 133627883,
+    133693433, 133758967, 133824503, 133890047, 133955581, 134021101, 134086639, 134152189,
+    134217689, 134283257, 134348789, 134414327, 134479871, 134545399, 134610929, 134676469,
+    134742007, 134807503, 134873083, 134938619, 135004141, 135069679, 135135229, 135200753,
+    135266293, 135331837, 135397373, 135462907, 135528439, 135593957, 135659483, 135724973,
+    135790547, 135856121, 135921661, 135987193, 136052723, 136118249, 136183807, 136249343,
+    136314869, 136380403, 136445951, 136511471, 136577011, 136642559, 136708093, 136773613,
+    136839133, 136904701, 136970233, 137035763, 137101297, 137166823, 137232353, 137297903,
+    137363431, 137428961, 137494501, 137560061, 137625599, 137691061, 137756659, 137822177,
+    137887741, 137953273, 138018781, 138084329, 138149831, 138215417, 138280957, 138346489,
+    138412031, 138477551, 138543103, 138608579, 138674171, 138739633, 138805237, 138870769,
+    138936319, 139001851, 139067387, 139132909, 139198459, 139263953, 139329523, 139395031,
+    139460591, 139526129, 139591663, 139657183, 139722749, 139788283, 139853807, 139919357,
+    139984829, 140050399, 140115967, 140181491, 140246947, 140312567, 140378107, 140443627,
+    140509183, 140574719, 140640251, 140705779, 140771317, 140836849, 140902369, 140967923,
+    141033463, 141099001, 141164503, 141230077, 141295603, 141361139, 141426667, 141492223,
+    141557723, 141623291, 141688831, 141754367, 141819901, 141885439, 141950971, 142016473,
+    142082023, 142147553, 142213091, 142278641, 142344131, 142409723, 142475261, 142540787,
+    142606333, 142671833, 142737401, 142802927, 142868461, 142933993, 142999543, 143065063,
+    143130607, 143196139, 143261689, 143327201, 143392727, 143458283, 143523829, 143589343,
+    143654909, 143720419, 143785981, 143851511, 143917027, 143982581, 144048083, 144113623,
+    144179197, 144244733, 144310261, 144375779, 144441317, 144506863, 144572413, 144637919,
+    144703477, 144768997, 144834559, 144900089, 144965629, 145031167, 145096697, 145162183,
+    145227769, 145293307, 145358839, 145424381, 145489909, 145555441, 145620991, 145686521,
+    145752053, 145817591, 145883107, 145948667, 146014177, 146079701, 146145271, 146210783,
+    146276329, 146341883, 146407423, 146472959, 146538493, 146604023, 146669543, 146735089,
+};
+// clang-format on
+
+}  // namespace detail
+}  // namespace ethash
@@ -0,0 +1,28 @@
+// firominer: precomputed ethash epoch sizes.
+// Licensed under the Apache License, Version 2.0.
+
+// Written by Firominer's authors 2021
+
+#pragma once
+#ifndef CRYPTO_EPOCH_SIZES_HPP_
+#define CRYPTO_EPOCH_SIZES_HPP_
+
+#include <cstdint>
+
+namespace ethash
+{
+namespace detail
+{
+// Number of epochs covered by the tables. At 1300 blocks of 5 minutes per
+// epoch that's about 25 years. Later epochs fall back to the prime search.
+constexpr uint32_t kEpoch_sizes_count = 2048;
+
+// Light cache and full dataset item counts per epoch, as returned by
+// calculate_light_cache_num_items() and calculate_full_dataset_num_items()
+extern const uint32_t light_cache_num_items_table[kEpoch_sizes_count];
+extern const uint32_t full_dataset_num_items_table[kEpoch_sizes_count];
+
+}  // namespace detail
+}  // namespace ethash
+
+#endif  // !CRYPTO_EPOCH_SIZES_HPP_
@@ -4,42 +4,25 @@
 
 // Modified by Firominer's authors 2021
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "bitwise.hpp"
+#include "dispatch.hpp"
+#include "epoch_sizes.hpp"
 #include "ethash.hpp"
 
 namespace ethash
 {
 namespace detail
 {
-std::mutex shared_context_mutex;
-std::shared_ptr<epoch_context> shared_context;
-thread_local std::shared_ptr<epoch_context> thread_local_context;
-
-ATTRIBUTE_NOINLINE
-void update_local_context(int epoch_number, bool full)
-{
-    // Release the shared pointer of the obsoleted context.
-    thread_local_context.reset();
-
-    // Local context invalid, check the shared context.
-    std::lock_guard<std::mutex> lock{shared_context_mutex};
-
-    if (!shared_context || shared_context->epoch_number != epoch_number ||
-        full != (shared_context->full_dataset != nullptr))
-    {
-        // Release the shared pointer of the obsoleted context.
-        shared_context.reset();
-
-        // Build new context.
-        shared_context = {create_epoch_context(epoch_number, full), destroy_epoch_context};
-    }
-
-    thread_local_context = shared_context;
-}
-
-
 static inline hash512 fnv1_512(const hash512& a, const hash512& b) noexcept
 {
     hash512 ret{};
@@ -60,33 +43,128 @@ static inline hash512 xor_512(const hash512& x, const hash512& y) noexcept
     return z;
 }
 
+/// Computes keccak512 of N independent inputs using the widest batched sponge available.
+template <size_t N>
+static inline ALWAYS_INLINE void keccak512_lanes(hash512 out[N], const hash512 in[N]) noexcept
+{
+    if constexpr (N == 8)
+    {
+        keccak512_x8(out, in);
+    }
+    else if constexpr (N == 4)
+    {
+        keccak512_x4(out, in);
+    }
+    else
+    {
+        for (size_t i{0}; i < N; ++i)
+            out[i] = keccak512(in[i]);
+    }
+}
+
+/// The state of N consecutive dataset item lanes (512-bit each) computed side by side.
+/// Lanes are independent, so the keccak512 at both ends of the parent mixing run batched.
+template <size_t N>
 struct item_state
 {
     const hash512* const cache;
     const uint32_t num_cache_items;
-    const uint32_t seed;
 
-    hash512 mix;
+    uint32_t seeds[N];
+    hash512 mixes[N];
 
-    ALWAYS_INLINE item_state(const epoch_context& context, uint32_t index) noexcept
-      : cache{context.light_cache}, num_cache_items{context.light_cache_num_items}, seed{index}
+    ALWAYS_INLINE item_state(const epoch_context& context, uint32_t first_seed) noexcept
+      : cache{context.light_cache}, num_cache_items{context.light_cache_num_items}
     {
-        mix = cache[index % num_cache_items];
-        mix.word32s[0] ^= le::uint32(seed);
-        mix = le::uint32s(keccak512(mix));
+        for (size_t i{0}; i < N; ++i)
+        {
+            seeds[i] = first_seed + static_cast<uint32_t>(i);
+            mixes[i] = cache[seeds[i] % num_cache_items];
+            mixes[i].word32s[0] ^= le::uint32(seeds[i]);
+        }
+
+        keccak512_lanes<N>(mixes, mixes);
+        for (auto& mix : mixes)
+            mix = le::uint32s(mix);
     }
 
     ALWAYS_INLINE void update(uint32_t round) noexcept
     {
-        static constexpr size_t num_words = sizeof(mix) / sizeof(uint32_t);
-        const uint32_t t = crypto::fnv1(seed ^ round, mix.word32s[round % num_words]);
-        const int64_t parent_index = t % num_cache_items;
-        mix = fnv1_512(mix, le::uint32s(cache[parent_index]));
+        static constexpr size_t num_words = sizeof(hash512) / sizeof(uint32_t);
+        for (size_t i{0}; i < N; ++i)
+        {
+            const uint32_t t = crypto::fnv1(seeds[i] ^ round, mixes[i].word32s[round % num_words]);
+            const int64_t parent_index = t % num_cache_items;
+            mixes[i] = fnv1_512(mixes[i], le::uint32s(cache[parent_index]));
+        }
     }
 
-    ALWAYS_INLINE hash512 final() noexcept { return keccak512(le::uint32s(mix)); }
+    ALWAYS_INLINE void final(hash512 out[N]) noexcept
+    {
+        for (size_t i{0}; i < N; ++i)
+            out[i] = le::uint32s(mixes[i]);
+        keccak512_lanes<N>(out, out);
+    }
 };
 
+/// Runs the parent rounds of a group of item lanes. This is where the bulk of a dataset
+/// item is spent (light cache loads and fnv1_512) so it is built for every instruction
+/// set tier and picked at runtime (see dispatch.hpp).
+template <size_t N>
+static inline ALWAYS_INLINE void mix_item_parents(item_state<N>& items) noexcept
+{
+    for (uint32_t i{0}; i < kFull_dataset_item_parents; ++i)
+        items.update(i);
+}
+
+template <size_t N>
+static void mix_item_parents_generic(item_state<N>& items) noexcept
+{
+    mix_item_parents(items);
+}
+
+#if HAVE_X86_TARGET_DISPATCH
+template <size_t N>
+ATTRIBUTE_TARGET("sse4.1,sse4.2") static void mix_item_parents_sse4(item_state<N>& items) noexcept
+{
+    mix_item_parents(items);
+}
+
+template <size_t N>
+ATTRIBUTE_TARGET("avx2,bmi,bmi2") static void mix_item_parents_avx2(item_state<N>& items) noexcept
+{
+    mix_item_parents(items);
+}
+
+template <size_t N>
+ATTRIBUTE_TARGET("avx512f,avx2,bmi,bmi2") static void mix_item_parents_avx512(item_state<N>& items) noexcept
+{
+    mix_item_parents(items);
+}
+#endif
+
+template <size_t N>
+using mix_item_parents_fn = void (*)(item_state<N>&) noexcept;
+
+template <size_t N>
+static mix_item_parents_fn<N> mix_item_parents_best = mix_item_parents_generic<N>;
+
+template <size_t N>
+static void select_mix_item_parents(crypto::simd_level level) noexcept
+{
+    mix_item_parents_best<N> = mix_item_parents_generic<N>;
+#if HAVE_X86_TARGET_DISPATCH
+    if (level >= crypto::simd_level::avx512)
+        mix_item_parents_best<N> = mix_item_parents_avx512<N>;
+    else if (level >= crypto::simd_level::avx2)
+        mix_item_parents_best<N> = mix_item_parents_avx2<N>;
+    else if (level >= crypto::simd_level::sse4)
+        mix_item_parents_best<N> = mix_item_parents_sse4<N>;
+#else
+    (void)level;
+#endif
+}
+
 hash1024 lazy_lookup_1024(const epoch_context& context, uint32_t index) noexcept
 {
     // l1_cache has the first 128 hash1024 items
@@ -98,15 +176,7 @@ hash1024 lazy_lookup_1024(const epoch_context& context, uint32_t index) noexcept
     }
 
     if (context.full_dataset)
-    {
-        hash1024& item = context.full_dataset[index];
-        if (item.word64s[0] == 0)
-        {
-            // TODO: Copy elision here makes it thread-safe?
-            item = calculate_dataset_item_1024(context, index);
-        }
-        return item;
-    }
+        return context.full_dataset[index];
 
     auto item = calculate_dataset_item_1024(context, index);
     return item;
@@ -123,50 +193,51 @@ hash2048 lazy_lookup_2048(const epoch_context& context, uint32_t index) noexcept
     }
 
     if (context.full_dataset)
-    {
-        hash2048& item = reinterpret_cast<hash2048*>(context.full_dataset)[index];
-        if (item.word64s[0] == 0)
-        {
-            // TODO: Copy elision here makes it thread-safe?
-            item = calculate_dataset_item_2048(context, index);
-        }
+        return reinterpret_cast<const hash2048*>(context.full_dataset)[index];
+
+    hash2048 item;
+    auto* cache = get_item_cache(context);
+    if (cache && item_cache_find(*cache, index, &item))
         return item;
-    }
 
-    auto item = calculate_dataset_item_2048(context, index);
+    item = calculate_dataset_item_2048(context, index);
+    if (cache)
+        item_cache_insert(*cache, index, &item);
     return item;
 }
 
 hash1024 calculate_dataset_item_1024(const epoch_context& context, uint32_t index) noexcept
 {
-    item_state item0{context, static_cast<uint32_t>(static_cast<uint64_t>(index) * 2)};
-    item_state item1{context, static_cast<uint32_t>(static_cast<uint64_t>(index) * 2) + 1};
+    item_state<2> items{context, static_cast<uint32_t>(static_cast<uint64_t>(index) * 2)};
 
-    for (uint32_t i{0}; i < kFull_dataset_item_parents; ++i)
-    {
-        item0.update(i);
-        item1.update(i);
-    }
+    mix_item_parents_best<2>(items);
 
-    return hash1024{{item0.final(), item1.final()}};
+    hash1024 item;
+    items.final(item.hash512s);
+    return item;
 }
 
 hash2048 calculate_dataset_item_2048(const epoch_context& context, uint32_t index) noexcept
 {
-    item_state item0{context, static_cast<uint32_t>(static_cast<uint64_t>(index) * 4)};
-    item_state item1{context, static_cast<uint32_t>(static_cast<uint64_t>(index) * 4) + 1};
-    item_state item2{context, static_cast<uint32_t>(static_cast<uint64_t>(index) * 4) + 2};
-    item_state item3{context, static_cast<uint32_t>(static_cast<uint64_t>(index) * 4) + 3};
+    item_state<4> items{context, static_cast<uint32_t>(static_cast<uint64_t>(index) * 4)};
 
-    for (uint32_t i{0}; i < kFull_dataset_item_parents; ++i)
-    {
-        item0.update(i);
-        item1.update(i);
-        item2.update(i);
-        item3.update(i);
-    }
+    mix_item_parents_best<4>(items);
 
-    return hash2048{{item0.final(), item1.final(), item2.final(), item3.final()}};
+    hash2048 item;
+    items.final(item.hash512s);
+    return item;
+}
+
+void calculate_dataset_items_2048(const epoch_context& context, uint32_t index, hash2048 out[2]) noexcept
+{
+    item_state<8> items{context, static_cast<uint32_t>(static_cast<uint64_t>(index) * 4)};
+
+    mix_item_parents_best<8>(items);
+
+    hash512 lanes[8];
+    items.final(lanes);
+    std::memcpy(out[0].hash512s, &lanes[0], sizeof(hash2048));
+    std::memcpy(out[1].hash512s, &lanes[4], sizeof(hash2048));
 }
 
 void build_light_cache(hash_512_function hash_function, hash512 cache[], uint32_t num_items, const hash256& seed)
@@ -204,7 +275,27 @@ hash512 hash_seed(const hash256& header, uint64_t nonce) noexcept
     return keccak512(init_data, sizeof(init_data));
 }
 
-hash256 hash_mix(const epoch_context& context, const hash512& seed)
+/// Compresses a 1024-bit mix into the 256-bit mix hash.
+static inline hash256 reduce_mix(const hash1024& mix) noexcept
+{
+    static constexpr size_t num_words{sizeof(hash1024) / sizeof(uint32_t)};
+    hash256 mix_hash;
+
+    for (size_t i = 0; i < num_words; i += 4)
+    {
+        const uint32_t h1 = crypto::fnv1(mix.word32s[i], mix.word32s[i + 1]);
+        const uint32_t h2 = crypto::fnv1(h1, mix.word32s[i + 2]);
+        const uint32_t h3 = crypto::fnv1(h2, mix.word32s[i + 3]);
+        mix_hash.word32s[i / 4] = h3;
+    }
+
+    return le::uint32s(mix_hash);
+}
+
+/// The mix loop. With a full dataset (always completely built) items are plain loads,
+/// otherwise they're computed from the light cache.
+template <bool Full>
+static hash256 hash_mix(const epoch_context& context, const hash512& seed)
 {
     static constexpr size_t num_words{sizeof(hash1024) / sizeof(uint32_t)};
     const uint32_t index_limit{context.full_dataset_num_items};
@@ -215,23 +306,129 @@ hash256 hash_mix(const epoch_context& context, const hash512& seed)
     for (uint32_t i = 0; i < kNum_dataset_accesses; ++i)
     {
         const uint32_t p = crypto::fnv1(i ^ seed_init, mix.word32s[i % num_words]) % index_limit;
-        const hash1024 newdata = le::uint32s(lazy_lookup_1024(context, p));
+        const hash1024 newdata =
+            le::uint32s(Full ? context.full_dataset[p] : lazy_lookup_1024(context, p));
 
         for (size_t j = 0; j < num_words; ++j)
             mix.word32s[j] = crypto::fnv1(mix.word32s[j], newdata.word32s[j]);
     }
 
-    hash256 mix_hash;
+    return reduce_mix(mix);
+}
 
-    for (size_t i = 0; i < num_words; i += 4)
+hash256 hash_mix(const epoch_context& context, const hash512& seed)
+{
+    return context.full_dataset ? hash_mix<true>(context, seed) : hash_mix<false>(context, seed);
+}
+
+/// Prefetches both cache lines of a full dataset item.
+static inline ALWAYS_INLINE void prefetch_item(const epoch_context& context, uint32_t index) noexcept
+{
+    const auto* const item{reinterpret_cast<const char*>(&context.full_dataset[index])};
+    PREFETCH(item);
+    PREFETCH(item + 64);
+}
+
+/// The mix loops of up to kHash_batch_lanes nonces interleaved. Right after mixing an item
+/// each lane computes and prefetches its next access, so the dataset misses of all lanes
+/// are in flight together instead of one dependent miss after the other.
+template <bool Full>
+static inline ALWAYS_INLINE void hash_mix_lanes(
+    const epoch_context& context, const hash512 seeds[], hash256 mix_hashes[], size_t lanes) noexcept
+{
+    static constexpr size_t num_words{sizeof(hash1024) / sizeof(uint32_t)};
+    const uint32_t index_limit{context.full_dataset_num_items};
+
+    hash1024 mixes[kHash_batch_lanes];
+    uint32_t seed_inits[kHash_batch_lanes];
+    uint32_t indexes[kHash_batch_lanes];
+
+    for (size_t k{0}; k < lanes; ++k)
     {
-        const uint32_t h1 = crypto::fnv1(mix.word32s[i], mix.word32s[i + 1]);
-        const uint32_t h2 = crypto::fnv1(h1, mix.word32s[i + 2]);
-        const uint32_t h3 = crypto::fnv1(h2, mix.word32s[i + 3]);
-        mix_hash.word32s[i / 4] = h3;
+        seed_inits[k] = le::uint32(seeds[k].word32s[0]);
+        mixes[k] = hash1024{{le::uint32s(seeds[k]), le::uint32s(seeds[k])}};
+        indexes[k] = crypto::fnv1(seed_inits[k], mixes[k].word32s[0]) % index_limit;
+        if constexpr (Full)
+            prefetch_item(context, indexes[k]);
     }
 
-    return le::uint32s(mix_hash);
+    for (uint32_t i{0}; i < kNum_dataset_accesses; ++i)
+    {
+        for (size_t k{0}; k < lanes; ++k)
+        {
+            const hash1024 newdata =
+                le::uint32s(Full ? context.full_dataset[indexes[k]] : lazy_lookup_1024(context, indexes[k]));
+
+            for (size_t j{0}; j < num_words; ++j)
+                mixes[k].word32s[j] = crypto::fnv1(mixes[k].word32s[j], newdata.word32s[j]);
+
+            if (i + 1 < kNum_dataset_accesses)
+            {
+                indexes[k] =
+                    crypto::fnv1((i + 1) ^ seed_inits[k], mixes[k].word32s[(i + 1) % num_words]) % index_limit;
+                if constexpr (Full)
+                    prefetch_item(context, indexes[k]);
+            }
+        }
+    }
+
+    for (size_t k{0}; k < lanes; ++k)
+        mix_hashes[k] = reduce_mix(mixes[k]);
+}
+
+template <bool Full>
+static void hash_mix_lanes_generic(
+    const epoch_context& context, const hash512 seeds[], hash256 mix_hashes[], size_t lanes) noexcept
+{
+    hash_mix_lanes<Full>(context, seeds, mix_hashes, lanes);
+}
+
+#if HAVE_X86_TARGET_DISPATCH
+template <bool Full>
+ATTRIBUTE_TARGET("sse4.1,sse4.2")
+static void hash_mix_lanes_sse4(
+    const epoch_context& context, const hash512 seeds[], hash256 mix_hashes[], size_t lanes) noexcept
+{
+    hash_mix_lanes<Full>(context, seeds, mix_hashes, lanes);
+}
+
+template <bool Full>
+ATTRIBUTE_TARGET("avx2,bmi,bmi2")
+static void hash_mix_lanes_avx2(
+    const epoch_context& context, const hash512 seeds[], hash256 mix_hashes[], size_t lanes) noexcept
+{
+    hash_mix_lanes<Full>(context, seeds, mix_hashes, lanes);
+}
+
+template <bool Full>
+ATTRIBUTE_TARGET("avx512f,avx2,bmi,bmi2")
+static void hash_mix_lanes_avx512(
+    const epoch_context& context, const hash512 seeds[], hash256 mix_hashes[], size_t lanes) noexcept
+{
+    hash_mix_lanes<Full>(context, seeds, mix_hashes, lanes);
+}
+#endif
+
+using hash_mix_lanes_fn = void (*)(const epoch_context&, const hash512[], hash256[], size_t) noexcept;
+
+// Indexed by whether the context has a full dataset
+template <bool Full>
+static hash_mix_lanes_fn hash_mix_lanes_best = hash_mix_lanes_generic<Full>;
+
+template <bool Full>
+static void select_hash_mix_lanes(crypto::simd_level level) noexcept
+{
+    hash_mix_lanes_best<Full> = hash_mix_lanes_generic<Full>;
+#if HAVE_X86_TARGET_DISPATCH
+    if (level >= crypto::simd_level::avx512)
+        hash_mix_lanes_best<Full> = hash_mix_lanes_avx512<Full>;
+    else if (level >= crypto::simd_level::avx2)
+        hash_mix_lanes_best<Full> = hash_mix_lanes_avx2<Full>;
+    else if (level >= crypto::simd_level::sse4)
+        hash_mix_lanes_best<Full> = hash_mix_lanes_sse4<Full>;
+#else
+    (void)level;
+#endif
 }
 
 hash256 hash_final(const hash512& seed, const hash256& mix) noexcept
@@ -242,7 +439,114 @@ hash256 hash_final(const hash512& seed, const hash256& mix) noexcept
     return keccak256(final_data, sizeof(final_data));
 }
 
-epoch_context* create_epoch_context(uint32_t epoch_number, bool full)
+/// Generates the items of a chunk of the full dataset, pairwise where possible.
+static void build_dataset_chunk(const epoch_context& context, uint32_t begin, uint32_t end) noexcept
+{
+    auto* const items{reinterpret_cast<hash2048*>(context.full_dataset)};
+    uint32_t i{begin};
+    for (; i + 1 < end; i += 2)
+        calculate_dataset_items_2048(context, i, &items[i]);
+    if (i < end)
+        items[i] = calculate_dataset_item_2048(context, i);
+}
+
+bool build_full_dataset(epoch_context& context, const dataset_build_options& options)
+{
+    using namespace std::chrono_literals;
+
+    // The first items are already there as they share memory with l1_cache
+    const uint32_t first_item{kL1_cache_size / sizeof(hash2048)};
+    const uint32_t num_items{context.full_dataset_num_items / 2};
+    const uint32_t chunk_items{std::max(options.chunk_items, 1u)};
+
+    unsigned num_threads{options.num_threads ? options.num_threads : std::thread::hardware_concurrency()};
+    num_threads = std::clamp(num_threads, 1u, (num_items - first_item + chunk_items - 1) / chunk_items);
+
+    std::atomic<uint32_t> next_item{first_item};
+    std::atomic<uint32_t> done_items{first_item};
+    std::atomic<bool> cancelled{false};
+    std::mutex mutex;
+    std::condition_variable cv;
+    unsigned running{0};
+
+    auto worker = [&]() {
+        while (!cancelled.load(std::memory_order_relaxed))
+        {
+            const uint32_t begin{next_item.fetch_add(chunk_items, std::memory_order_relaxed)};
+            if (begin >= num_items)
+                break;
+            const uint32_t end{std::min(begin + chunk_items, num_items)};
+            build_dataset_chunk(context, begin, end);
+            done_items.fetch_add(end - begin, std::memory_order_relaxed);
+        }
+        std::lock_guard<std::mutex> lock{mutex};
+        if (--running == 0)
+            cv.notify_one();
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    try
+    {
+        for (unsigned i{0}; i < num_threads; ++i)
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            threads.emplace_back(worker);
+            ++running;
+        }
+    }
+    catch (...)
+    {
+        cancelled = true;
+        for (auto& thread : threads)
+            thread.join();
+        throw;
+    }
+
+    // Progress is reported from here so the callback never runs on a worker. If it
+    // throws the workers are stopped and joined first
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        while (!cv.wait_for(lock, 500ms, [&] { return running == 0; }))
+        {
+            if (!options.progress || cancelled)
+                continue;
+            lock.unlock();
+            try
+            {
+                if (!options.progress(done_items.load(std::memory_order_relaxed), num_items))
+                    cancelled = true;
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+                cancelled = true;
+            }
+            lock.lock();
+        }
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    if (error)
+        std::rethrow_exception(error);
+    if (cancelled)
+        return false;
+
+    // An odd number of 1024-bit items leaves one out of the 2048-bit ones
+    if (context.full_dataset_num_items % 2)
+    {
+        const uint32_t last{context.full_dataset_num_items - 1};
+        context.full_dataset[last] = calculate_dataset_item_1024(context, last);
+    }
+
+    if (options.progress)
+        options.progress(num_items, num_items);
+    return true;
+}
+
+epoch_context* create_epoch_context(uint32_t epoch_number, bool full, const dataset_build_options& options)
 {
     static constexpr size_t context_alloc_size{sizeof(epoch_context)};
     const uint32_t light_cache_num_items{calculate_light_cache_num_items(epoch_number)};
@@ -255,7 +559,8 @@ epoch_context* create_epoch_context(uint32_t epoch_number, bool full)
     const size_t alloc_size{context_alloc_size + light_cache_size + full_dataset_size};
 
     // Allocate light_cache memory
-    char* const alloc_data = static_cast<char*>(std::calloc(1, alloc_size));
+    page_type pages{page_type::normal};
+    char* const alloc_data = static_cast<char*>(allocate_epoch_memory(alloc_size, pages, options.numa_node));
     if (!alloc_data)
     {
         throw std::runtime_error("Out of memory");
@@ -268,21 +573,54 @@ epoch_context* create_epoch_context(uint32_t epoch_number, bool full)
     uint32_t* const l1_cache{reinterpret_cast<uint32_t*>(alloc_data + context_alloc_size + light_cache_size)};
     hash1024* full_dataset{full ? reinterpret_cast<hash1024*>(l1_cache) : nullptr};
 
-    epoch_context* const context =
+    // Owned until returned, the dataset build may throw
+    epoch_context_ptr context{
         new (alloc_data) epoch_context{epoch_number, light_cache_num_items, get_light_cache_size(light_cache_num_items),
-            full_dataset_num_items, get_full_dataset_size(full_dataset_num_items), light_cache, l1_cache, full_dataset};
+            full_dataset_num_items, get_full_dataset_size(full_dataset_num_items), light_cache, l1_cache, full_dataset,
+            pages},
+        destroy_epoch_context};
 
     auto* full_dataset_2048 = reinterpret_cast<hash2048*>(l1_cache);
 
-    for (uint32_t i{0}; i < kL1_cache_size / sizeof(hash2048); ++i)
-        full_dataset_2048[i] = calculate_dataset_item_2048(*context, i);
-    return context;
+    for (uint32_t i{0}; i < kL1_cache_size / sizeof(hash2048); i += 2)
+        calculate_dataset_items_2048(*context, i, &full_dataset_2048[i]);
+
+    if (full && !build_full_dataset(*context, options))
+        return nullptr;
+    return context.release();
+}
+
+epoch_context* clone_epoch_context(const epoch_context& context, int numa_node)
+{
+    static constexpr size_t context_alloc_size{sizeof(epoch_context)};
+    const bool full{context.full_dataset != nullptr};
+    const size_t data_size{context.light_cache_size + (full ? context.full_dataset_size : kL1_cache_size)};
+    const size_t alloc_size{context_alloc_size + data_size};
+
+    page_type pages{page_type::normal};
+    char* const alloc_data = static_cast<char*>(allocate_epoch_memory(alloc_size, pages, numa_node));
+    if (!alloc_data)
+    {
+        throw std::runtime_error("Out of memory");
+    }
+
+    // Light cache and l1_cache / full dataset are contiguous
+    std::memcpy(alloc_data + context_alloc_size, context.light_cache, data_size);
+
+    auto* const light_cache{reinterpret_cast<hash512*>(alloc_data + context_alloc_size)};
+    auto* const l1_cache{reinterpret_cast<uint32_t*>(alloc_data + context_alloc_size + context.light_cache_size)};
+    return new (alloc_data) epoch_context{context.epoch_number, context.light_cache_num_items,
+        context.light_cache_size, context.full_dataset_num_items, context.full_dataset_size, light_cache, l1_cache,
+        full ? reinterpret_cast<hash1024*>(l1_cache) : nullptr, pages};
 }
 
 void destroy_epoch_context(epoch_context* context) noexcept
 {
+    const size_t alloc_size{sizeof(epoch_context) + context->light_cache_size +
+                            (context->full_dataset ? context->full_dataset_size : kL1_cache_size)};
+    const page_type pages{context->pages};
     context->~epoch_context();
-    std::free(context);
+    free_epoch_memory(context, alloc_size, pages);
 }
 
 }  // namespace detail
@@ -346,6 +684,9 @@ uint32_t calculate_light_cache_num_items(uint32_t epoch_number) noexcept
     static_assert(kLight_cache_init_size % item_size == 0, "light_cache_init_size not multiple of item size");
     static_assert(kLight_cache_growth % item_size == 0, "light_cache_growth not multiple of item size");
 
+    if (epoch_number < detail::kEpoch_sizes_count)
+        return detail::light_cache_num_items_table[epoch_number];
+
     uint32_t num_items_upper_bound = num_items_init + epoch_number * num_items_growth;
     uint32_t num_items = find_largest_unsigned_prime(num_items_upper_bound);
     return num_items;
@@ -359,15 +700,49 @@ uint32_t calculate_full_dataset_num_items(uint32_t epoch_number) noexcept
     static_assert(kFull_dataset_init_size % item_size == 0, "full_dataset_init_size not multiple of item size");
     static_assert(kFull_dataset_growth % item_size == 0, "full_dataset_growth not multiple of item size");
 
+    if (epoch_number < detail::kEpoch_sizes_count)
+        return detail::full_dataset_num_items_table[epoch_number];
+
     uint32_t num_items_upper_bound = num_items_init + epoch_number * num_items_growth;
     uint32_t num_items = find_largest_unsigned_prime(num_items_upper_bound);
     return num_items;
 }
 
+/// Epoch seeds are a keccak256 chain. Seeds up to the horizon are computed once
+/// (~10 ms) on first use and indexed by their first word so both directions are O(1).
+static constexpr uint32_t kSeed_table_horizon{30000};
+
+struct seed_table
+{
+    std::vector<hash256> seeds;                     // seeds[epoch_number]
+    std::unordered_map<uint64_t, uint32_t> epochs;  // First seed word to epoch number
+};
+
+static const seed_table& get_seed_table()
+{
+    static const seed_table table{[] {
+        seed_table t;
+        t.seeds.resize(kSeed_table_horizon);
+        t.epochs.reserve(kSeed_table_horizon);
+        for (uint32_t i{0}; i < kSeed_table_horizon; ++i)
+        {
+            t.seeds[i] = i ? keccak256(t.seeds[i - 1]) : hash256{};
+            t.epochs.emplace(t.seeds[i].word64s[0], i);
+        }
+        return t;
+    }()};
+    return table;
+}
+
 hash256 calculate_seed_from_epoch(uint32_t epoch_number) noexcept
 {
-    hash256 seed{};
-    for (uint32_t i{0}; i < epoch_number; ++i)
+    const seed_table& table{get_seed_table()};
+    if (epoch_number < kSeed_table_horizon)
+        return table.seeds[epoch_number];
+
+    // Beyond the horizon continue the chain from its last seed
+    hash256 seed{table.seeds.back()};
+    for (uint32_t i{kSeed_table_horizon - 1}; i < epoch_number; ++i)
     {
         seed = keccak256(seed);
     }
@@ -376,42 +751,23 @@ hash256 calculate_seed_from_epoch(uint32_t epoch_number) noexcept
 
 std::optional<uint32_t> calculate_epoch_from_seed(const hash256& seed) noexcept
 {
-    static constexpr uint32_t num_tries{30000};
-    static thread_local std::optional<uint32_t> cached_epoch_number{};
-    static thread_local hash256 cached_epoch_seed{};
-
-    // Do we have something in cache ?
-    if (cached_epoch_number.has_value())
+    const seed_table& table{get_seed_table()};
+    const auto it{table.epochs.find(seed.word64s[0])};
+    if (it != table.epochs.end() && is_equal(table.seeds[it->second], seed))
     {
-        if (is_equal(seed, cached_epoch_seed))
-        {
-            return cached_epoch_number.value();
-        }
-        // Try the next seed, will match for sequential epoch access.
-        hash256 next{keccak256(cached_epoch_seed)};
-        if (is_equal(next, seed))
-        {
-            cached_epoch_seed = next;
-            *cached_epoch_number = *cached_epoch_number + 1;
-            return cached_epoch_number.value();
-        }
+        return it->second;
     }
 
-    // Nothing in cache or not next in sequence ...
-    // restart linear search from epoch 0
-    cached_epoch_seed = {};
-    for (uint32_t i{0}; i < num_tries; i++)
+    // Only a first word collision within the table can get here with a valid seed
+    for (uint32_t i{0}; i < kSeed_table_horizon; ++i)
     {
-        if (is_equal(cached_epoch_seed, seed))
+        if (is_equal(table.seeds[i], seed))
         {
-            cached_epoch_number.emplace(i);
-            return cached_epoch_number.value();
+            return i;
         }
-        cached_epoch_seed = keccak256(cached_epoch_seed);
     }
 
     // No matches found
-    cached_epoch_number.reset();
     return std::nullopt;
 }
 
@@ -427,6 +783,27 @@ result hash(const epoch_context& context, const hash256& header, uint64_t nonce)
     return {detail::hash_final(seed, mix_hash), mix_hash};
 }
 
+void hash_batch(const epoch_context& context, const hash256& header, uint64_t start_nonce, size_t count, result out[])
+{
+    for (size_t first{0}; first < count; first += kHash_batch_lanes)
+    {
+        const size_t lanes{std::min(count - first, kHash_batch_lanes)};
+        hash512 seeds[kHash_batch_lanes];
+        hash256 mix_hashes[kHash_batch_lanes];
+
+        for (size_t k{0}; k < lanes; ++k)
+            seeds[k] = detail::hash_seed(header, start_nonce + first + k);
+
+        if (context.full_dataset)
+            detail::hash_mix_lanes_best<true>(context, seeds, mix_hashes, lanes);
+        else
+            detail::hash_mix_lanes_best<false>(context, seeds, mix_hashes, lanes);
+
+        for (size_t k{0}; k < lanes; ++k)
+            out[first + k] = {detail::hash_final(seeds[k], mix_hashes[k]), mix_hashes[k]};
+    }
+}
+
 bool verify_light(const hash256& header_hash, const hash256& mix_hash, uint64_t nonce, const hash256& boundary) noexcept
 {
     const hash512 hash_seed{detail::hash_seed(header_hash, nonce)};
@@ -456,21 +833,11 @@ VerificationResult verify_full(const uint64_t block_num, const hash256& header_h
 {
     auto epoch_number{calculate_epoch_from_block_num(block_num)};
     auto epoch_context{get_epoch_context(epoch_number, false)};
+    if (!epoch_context)
+        return VerificationResult::kInvalidMixHash;  // Can't tell, don't vouch for it
     return verify_full(*epoch_context, header_hash, mix_hash, nonce, boundary);
 }
 
-std::shared_ptr<epoch_context> get_epoch_context(uint32_t epoch_number, bool full) noexcept
-{
-    // Check if local context matches epoch number.
-    if (!detail::thread_local_context || detail::thread_local_context->epoch_number != epoch_number ||
-        full != (detail::thread_local_context->full_dataset != nullptr))
-    {
-        detail::update_local_context(epoch_number, full);
-    }
-
-    return detail::thread_local_context;
-}
-
 hash256 get_boundary_from_diff(const intx::uint256 difficulty) noexcept
 {
     static intx::uint256 dividend{
@@ -498,3 +865,12 @@ hash256 from_bytes(const uint8_t* data)
 }
 
 }  // namespace ethash
+
+void crypto::detail::select_ethash_kernels(simd_level level) noexcept
+{
+    ethash::detail::select_mix_item_parents<2>(level);
+    ethash::detail::select_mix_item_parents<4>(level);
+    ethash::detail::select_mix_item_parents<8>(level);
+    ethash::detail::select_hash_mix_lanes<false>(level);
+    ethash::detail::select_hash_mix_lanes<true>(level);
+}
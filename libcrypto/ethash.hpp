@@ -8,12 +8,16 @@
 #ifndef CRYPTO_ETHASH_HPP_
 #define CRYPTO_ETHASH_HPP_
 
+#include <functional>
+#include <future>
 #include <memory>
 #include <optional>
 
 #include <intx/intx.hpp>
 
 #include "attributes.hpp"
+#include "epoch_memory.hpp"
+#include "item_cache.hpp"
 #include "keccak.hpp"
 
 namespace ethash
@@ -42,6 +46,7 @@ constexpr static uint32_t kL1_cache_words = kL1_cache_size / sizeof(uint32_t);
 constexpr static uint32_t kFull_dataset_init_size = (1 << 30) + (1 << 29); // Firo initial DAG size such as at block 400K they're above 4GB
 constexpr static uint32_t kFull_dataset_growth = 1 << 23;
 constexpr static uint32_t kFull_dataset_item_parents = 512;
+constexpr static size_t kHash_batch_lanes = 8;  // Nonces in flight in hash_batch()
 
 struct epoch_context
 {
@@ -53,6 +58,8 @@ struct epoch_context
     const hash512* const light_cache;
     const uint32_t* const l1_cache;
     hash1024* full_dataset;
+    const page_type pages{page_type::normal};  // Pages backing light cache and dataset
+    detail::item_cache_holder item_cache{};     // Computed items of a light context
 };
 
 
@@ -69,6 +76,21 @@ enum class VerificationResult
     kInvalidMixHash  // Provided mix_hash does not match with computed
 };
 
+/**
+ * Reports the progress of a full dataset build as the number of 2048-bit items
+ * generated so far out of the total. It is always invoked from the thread which
+ * requested the build. Returning false cancels the build.
+ */
+using build_progress_fn = std::function<bool(uint32_t done, uint32_t total)>;
+
+struct dataset_build_options
+{
+    unsigned num_threads{0};        // Worker threads. 0 means all hardware threads
+    uint32_t chunk_items{1024};     // Number of 2048-bit items each worker grabs at once
+    build_progress_fn progress{};   // Optional progress callback
+    int numa_node{-1};              // NUMA node the context memory is bound to. Negative for none
+};
+
 namespace detail
 {
 // using lookup_fn = hash1024 (*)(const epoch_context&, uint32_t);
@@ -79,6 +101,12 @@ hash2048 lazy_lookup_2048(const epoch_context& context, uint32_t index) noexcept
 hash1024 calculate_dataset_item_1024(const epoch_context& context, uint32_t index) noexcept;
 hash2048 calculate_dataset_item_2048(const epoch_context& context, uint32_t index) noexcept;
 
+/**
+ * Calculates the two consecutive 2048-bit dataset items `index` and `index + 1`
+ * at once, running their 8 lanes through the 8-way batched keccak512.
+ */
+void calculate_dataset_items_2048(const epoch_context& context, uint32_t index, hash2048 out[2]) noexcept;
+
 hash512 hash_seed(const hash256& header, uint64_t nonce) noexcept;
 hash256 hash_mix(const epoch_context& context, const hash512& seed);
 hash256 hash_final(const hash512& seed, const hash256& mix) noexcept;
@@ -86,9 +114,29 @@ hash256 hash_final(const hash512& seed, const hash256& mix) noexcept;
 void destroy_epoch_context(epoch_context* context) noexcept;
 
 /**
- * Creates the dag epoch context
+ * Generates every item of the full dataset of the context across a pool of threads.
+ * Once done the full dataset is read only and lookups are plain loads.
+ *
+ * @param context   A context created with a full dataset
+ * @param options   Threading, chunking and progress reporting options
+ * @return          False if the build has been cancelled by the progress callback
+ */
+bool build_full_dataset(epoch_context& context, const dataset_build_options& options);
+
+/**
+ * Creates the dag epoch context. When full is set the whole dataset is generated
+ * before returning (see build_full_dataset).
+ *
+ * @return          The new context or nullptr if the dataset build has been cancelled
+ */
+epoch_context* create_epoch_context(uint32_t epoch_number, bool full, const dataset_build_options& options = {});
+
+/**
+ * Copies a context into memory bound to the given NUMA node
+ *
+ * @return          The copy. Throws if out of memory
  */
-epoch_context* create_epoch_context(uint32_t epoch_number, bool full);
+epoch_context* clone_epoch_context(const epoch_context& context, int numa_node);
 
 }  // namespace detail
 
@@ -104,8 +152,9 @@ uint32_t find_largest_unsigned_prime(uint32_t upper_bound) noexcept;
 /**
  * Calculates the number of items in the light cache for given epoch.
  *
- * This function will search for a prime number matching the criteria given
- * by the Ethash so the execution time is not constant. It takes ~ 0.01 ms.
+ * Looked up from a precomputed table for the first 2048 epochs (see epoch_sizes.hpp),
+ * beyond that it searches for a prime number matching the criteria given by the
+ * Ethash so the execution time is not constant. It takes ~ 0.01 ms.
  *
  * @param epoch_number  The epoch number.
  * @return              The number items in the light cache.
@@ -115,8 +164,9 @@ uint32_t calculate_light_cache_num_items(uint32_t epoch_number) noexcept;
 /**
  * Calculates the number of items in the full dataset for given epoch.
  *
- * This function will search for a prime number matching the criteria given
- * by the Ethash so the execution time is not constant. It takes ~ 0.05 ms.
+ * Looked up from a precomputed table for the first 2048 epochs (see epoch_sizes.hpp),
+ * beyond that it searches for a prime number matching the criteria given by the
+ * Ethash so the execution time is not constant. It takes ~ 0.05 ms.
  *
  * @param epoch_number  The epoch number.
  * @return              The number items in the full dataset.
@@ -127,7 +177,7 @@ size_t get_light_cache_size(int num_items) noexcept;
 size_t get_full_dataset_size(int num_items) noexcept;
 
 /**
- * Calculates the epoch seed hash.
+ * Calculates the epoch seed hash. O(1) up to epoch 30000 (see calculate_epoch_from_seed).
  * @param epoch_number  The epoch number.
  * @return              The epoch seed hash.
  */
@@ -135,6 +185,8 @@ hash256 calculate_seed_from_epoch(uint32_t epoch_number) noexcept;
 
 /**
  * Calculates the epoch number provided a seed hash.
+ * Looks up a table of the seeds of the first 30000 epochs shared by all threads
+ * and built on first use.
  * @param seed          The hash256 seed
  * @return              The epoch number if found.
  */
@@ -157,6 +209,18 @@ uint32_t calculate_epoch_from_block_num(const uint64_t block_num) noexcept;
  */
 result hash(const epoch_context& context, const hash256& header, uint64_t nonce);
 
+/**
+ * Performs full ethash rounds for count consecutive nonces. Nonces are processed
+ * kHash_batch_lanes at a time with their dataset accesses interleaved and prefetched,
+ * which hides most of the memory latency of a full dataset.
+ * @param context       The DAG epoch context.
+ * @param header        The header hash of the block to be hashed
+ * @param start_nonce   The first nonce
+ * @param count         The number of nonces
+ * @param out           Receives count results, out[i] being for start_nonce + i
+ */
+void hash_batch(const epoch_context& context, const hash256& header, uint64_t start_nonce, size_t count, result out[]);
+
 /**
  * Verifies only the final hash provided a header hash and a mix hash
  * It does not traverse the memory hard part and
@@ -197,12 +261,45 @@ VerificationResult verify_full(const uint64_t block_num, const hash256& header_h
 using epoch_context_ptr = std::unique_ptr<epoch_context, decltype(&detail::destroy_epoch_context)>;
 
 /**
- * Creates an DAG context for given epoch number
+ * Returns the DAG context for given epoch number from the epoch context manager
+ * (see epoch_manager.hpp), building it if not resident.
+ * The returned pointer pins the context: it can't be evicted until all the
+ * pointers obtained for it are released.
  * @param epoch_number
- * @return              A unique_ptr to the context
+ * @param full          Whether the full dataset is needed
+ * @return              A pinning shared_ptr to the context, nullptr if it could not
+ *                      be built (out of memory)
  */
 std::shared_ptr<epoch_context> get_epoch_context(uint32_t epoch_number, bool full) noexcept;
 
+using epoch_context_future = std::shared_future<std::shared_ptr<epoch_context>>;
+using epoch_context_ready_fn = std::function<void(const std::shared_ptr<epoch_context>&)>;
+
+/**
+ * Same as get_epoch_context() without blocking the caller: the context is acquired,
+ * thus built if not resident, on a background thread.
+ * @param epoch_number
+ * @param full          Whether the full dataset is needed
+ * @param on_ready      Optional, invoked on the background thread with the pinning
+ *                      pointer once acquired, or nullptr if the build failed
+ * @return              A future of the pinning pointer. Holds the exception if the
+ *                      build failed
+ */
+epoch_context_future get_epoch_context_async(
+    uint32_t epoch_number, bool full, epoch_context_ready_fn on_ready = {});
+
+/**
+ * Returns the full DAG context for given epoch number with all its memory local to
+ * the given NUMA node. Each node has its own replica, the first one is built (or
+ * loaded from the epoch cache) and the others are copied from it.
+ * Pins the same way get_epoch_context() does.
+ * @param epoch_number
+ * @param numa_node
+ * @return              A pinning shared_ptr to the context, nullptr if it could not
+ *                      be built
+ */
+std::shared_ptr<epoch_context> get_numa_epoch_context(uint32_t epoch_number, unsigned numa_node) noexcept;
+
 hash256 get_boundary_from_diff(const intx::uint256 difficulty) noexcept;
 
 hash256 from_bytes(const uint8_t* data);
@@ -0,0 +1,192 @@
+// firominer: shared cache of computed dataset items for light contexts.
+// Licensed under the Apache License, Version 2.0.
+
+// Written by Firominer's authors 2021
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include "epoch_memory.hpp"
+#include "ethash.hpp"
+#include "item_cache.hpp"
+
+namespace ethash
+{
+namespace detail
+{
+namespace
+{
+std::atomic<size_t> item_cache_size{size_t{256} << 20};
+
+constexpr uint32_t kWays = 4;             // Slots per set
+constexpr uint32_t kCounter_stripes = 16;  // Hit/miss counters are striped over items
+
+/**
+ * A slot is guarded by a sequence lock: odd while written, bumped by 2 per write.
+ * Readers never wait and take a torn read as a miss. Tag 0 means empty, item 0
+ * is always served by the l1 cache.
+ */
+struct alignas(64) slot
+{
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint32_t> tag;
+    std::atomic<uint8_t> referenced;  // CLOCK bit
+    hash2048 item;
+};
+
+struct alignas(64) set
+{
+    slot slots[kWays];
+    std::atomic<uint32_t> hand;  // CLOCK hand
+};
+
+struct alignas(64) counters
+{
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+};
+
+}  // namespace
+
+class dataset_item_cache
+{
+public:
+    set* sets;  // Zeroed pages: every slot starts empty
+    uint32_t num_sets;
+    size_t memory_size;
+    page_type pages;
+    counters stripes[kCounter_stripes];
+
+    set& set_of(uint32_t index) noexcept
+    {
+        // Multiplicative hash then range reduction, so any number of sets fits the cap
+        const uint32_t hash{index * 0x9E3779B1u};
+        return sets[static_cast<uint64_t>(hash) * num_sets >> 32];
+    }
+
+    counters& stripe_of(uint32_t index) noexcept { return stripes[index % kCounter_stripes]; }
+};
+
+item_cache_holder::~item_cache_holder()
+{
+    if (auto* c = cache.load(std::memory_order_acquire))
+    {
+        free_epoch_memory(c->sets, c->memory_size, c->pages);
+        delete c;
+    }
+}
+
+dataset_item_cache* get_item_cache(const epoch_context& context) noexcept
+{
+    if (context.full_dataset)
+        return nullptr;
+    if (auto* c = context.item_cache.cache.load(std::memory_order_acquire))
+        return c;
+
+    const size_t num_sets{std::min<size_t>(item_cache_size.load(std::memory_order_relaxed) / sizeof(set),
+        context.full_dataset_num_items / 2 / kWays)};
+    if (!num_sets)
+        return nullptr;
+
+    auto* c = new (std::nothrow) dataset_item_cache{};
+    if (!c)
+        return nullptr;
+    c->memory_size = num_sets * sizeof(set);
+    c->num_sets = static_cast<uint32_t>(num_sets);
+    c->sets = static_cast<set*>(allocate_epoch_memory(c->memory_size, c->pages));
+    if (!c->sets)
+    {
+        delete c;
+        return nullptr;
+    }
+
+    // Another thread may have raced us
+    dataset_item_cache* expected{nullptr};
+    if (!context.item_cache.cache.compare_exchange_strong(expected, c, std::memory_order_acq_rel))
+    {
+        free_epoch_memory(c->sets, c->memory_size, c->pages);
+        delete c;
+        return expected;
+    }
+    return c;
+}
+
+bool item_cache_find(dataset_item_cache& cache, uint32_t index, void* out) noexcept
+{
+    set& s{cache.set_of(index)};
+    for (auto& sl : s.slots)
+    {
+        const uint32_t before{sl.sequence.load(std::memory_order_acquire)};
+        if ((before & 1) || sl.tag.load(std::memory_order_relaxed) != index)
+            continue;
+        std::memcpy(out, &sl.item, sizeof(hash2048));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sl.sequence.load(std::memory_order_relaxed) != before)
+            break;  // Overwritten while copying
+
+        if (!sl.referenced.load(std::memory_order_relaxed))
+            sl.referenced.store(1, std::memory_order_relaxed);
+        cache.stripe_of(index).hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    cache.stripe_of(index).misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void item_cache_insert(dataset_item_cache& cache, uint32_t index, const void* item) noexcept
+{
+    set& s{cache.set_of(index)};
+
+    // CLOCK: recently hit slots get a second chance
+    slot* victim{nullptr};
+    for (uint32_t i{0}; i < 2 * kWays; ++i)
+    {
+        slot& sl{s.slots[s.hand.fetch_add(1, std::memory_order_relaxed) % kWays]};
+        if (sl.referenced.load(std::memory_order_relaxed))
+        {
+            sl.referenced.store(0, std::memory_order_relaxed);
+            continue;
+        }
+        victim = &sl;
+        break;
+    }
+    if (!victim)
+        return;
+
+    uint32_t sequence{victim->sequence.load(std::memory_order_relaxed)};
+    if ((sequence & 1) ||
+        !victim->sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire))
+        return;
+    std::atomic_thread_fence(std::memory_order_release);
+
+    victim->tag.store(index, std::memory_order_relaxed);
+    std::memcpy(&victim->item, item, sizeof(hash2048));
+    victim->referenced.store(0, std::memory_order_relaxed);
+    victim->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+}  // namespace detail
+
+void set_dataset_item_cache_size(size_t bytes) noexcept
+{
+    detail::item_cache_size.store(bytes, std::memory_order_relaxed);
+}
+
+dataset_item_cache_stats get_dataset_item_cache_stats(const epoch_context& context) noexcept
+{
+    dataset_item_cache_stats stats;
+    auto* c = context.item_cache.cache.load(std::memory_order_acquire);
+    if (!c)
+        return stats;
+    for (const auto& stripe : c->stripes)
+    {
+        stats.hits += stripe.hits.load(std::memory_order_relaxed);
+        stats.misses += stripe.misses.load(std::memory_order_relaxed);
+    }
+    stats.capacity_items = static_cast<size_t>(c->num_sets) * detail::kWays;
+    stats.memory_size = c->memory_size;
+    return stats;
+}
+
+}  // namespace ethash
@@ -0,0 +1,81 @@
+// firominer: shared cache of computed dataset items for light contexts.
+// Licensed under the Apache License, Version 2.0.
+
+// Written by Firominer's authors 2021
+
+#pragma once
+#ifndef CRYPTO_ITEM_CACHE_HPP_
+#define CRYPTO_ITEM_CACHE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ethash
+{
+struct epoch_context;
+
+/**
+ * Counters of the dataset item cache of a light context
+ */
+struct dataset_item_cache_stats
+{
+    uint64_t hits{0};
+    uint64_t misses{0};       // Items computed from the light cache
+    size_t capacity_items{0}; // 2048-bit items the cache holds at most
+    size_t memory_size{0};    // Bytes reserved (pages are only backed once touched)
+};
+
+/**
+ * Sets the memory cap of the dataset item caches of the light contexts created from
+ * now on, one per context. 0 disables caching. Default 256 MiB.
+ *
+ * Light contexts compute each 2048-bit item they look up from 512 light cache parents
+ * (see lazy_lookup_2048). With a cache the items already computed by any thread are
+ * read back instead, whose hit rate grows with the cap over the full dataset size.
+ */
+void set_dataset_item_cache_size(size_t bytes) noexcept;
+
+/**
+ * Returns the counters of the cache of the context, all zero if it has none
+ */
+dataset_item_cache_stats get_dataset_item_cache_stats(const epoch_context& context) noexcept;
+
+namespace detail
+{
+class dataset_item_cache;
+
+/**
+ * Owner of the cache of a context, created on first lookup
+ */
+struct item_cache_holder
+{
+    mutable std::atomic<dataset_item_cache*> cache{nullptr};
+
+    item_cache_holder() = default;
+    item_cache_holder(const item_cache_holder&) = delete;
+    item_cache_holder& operator=(const item_cache_holder&) = delete;
+    ~item_cache_holder();
+};
+
+/**
+ * Returns the cache of a light context, creating it if needed, or nullptr when
+ * caching is disabled or the context has a full dataset
+ */
+dataset_item_cache* get_item_cache(const epoch_context& context) noexcept;
+
+/**
+ * Copies the item at index into out if cached
+ */
+bool item_cache_find(dataset_item_cache& cache, uint32_t index, void* out) noexcept;
+
+/**
+ * Stores an item. Best effort, gives up rather than waiting on a concurrent writer
+ */
+void item_cache_insert(dataset_item_cache& cache, uint32_t index, const void* item) noexcept;
+
+}  // namespace detail
+
+}  // namespace ethash
+
+#endif  // !CRYPTO_ITEM_CACHE_HPP_
@@ -7,6 +7,7 @@
 #include "keccak.hpp"
 #include "attributes.hpp"
 #include "bitwise.hpp"
+#include "dispatch.hpp"
 #include <string_view>
 
 namespace ethash
@@ -24,6 +25,28 @@ static inline ALWAYS_INLINE uint64_t load_le(const uint8_t* data)
     return le::uint64(word);
 }
 
+using crypto::rotl64;
+
+#if HAVE_X86_TARGET_DISPATCH
+/// Vectors of 64-bit words holding the same Keccak lane of 4 (AVX2) or 8 (AVX-512)
+/// independent states. Used to run the permutation on interleaved states.
+typedef uint64_t uint64x4_t __attribute__((vector_size(32)));
+typedef uint64_t uint64x8_t __attribute__((vector_size(64)));
+
+// Vector words are only handled by always inlined helpers within target("avx2")
+// and target("avx512f") functions, so the ABI of passing vectors by value never
+// comes into play for the rest of this file.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+template <typename word_t>
+static inline ALWAYS_INLINE word_t rotl64(const word_t& n, uint32_t s)
+{
+    return (n << s) | (n >> (64 - s));
+}
+#endif
+
 constexpr uint64_t round_constants_64[24] = {  //
     0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000,
     0x000000000000808b, 0x0000000080000001, 0x8000000080008081, 0x8000000000008009,
@@ -44,27 +67,30 @@ constexpr uint32_t round_constants_32[24] = {0x00000001, 0x00008082, 0x0000808A,
 /// The size of the state is also 1600 bit what gives 25 64-bit words.
 ///
 /// @param state  The state of 25 64-bit words on which the permutation is to be performed.
+///               When `word_t` is a vector of 64-bit words the same permutation is applied
+///               to as many interleaved states as the vector has lanes.
 ///
 /// The implementation based on:
 /// - "simple" implementation by Ronny Van Keer, included in "Reference and optimized code in C",
 ///   https://keccak.team/archives.html, CC0-1.0 / Public Domain.
-static inline ALWAYS_INLINE void keccakf1600_implementation(uint64_t state[25])
+template <typename word_t>
+static inline ALWAYS_INLINE void keccakf1600_implementation(word_t state[25])
 {
-    uint64_t Aba, Abe, Abi, Abo, Abu;
-    uint64_t Aga, Age, Agi, Ago, Agu;
-    uint64_t Aka, Ake, Aki, Ako, Aku;
-    uint64_t Ama, Ame, Ami, Amo, Amu;
-    uint64_t Asa, Ase, Asi, Aso, Asu;
+    word_t Aba, Abe, Abi, Abo, Abu;
+    word_t Aga, Age, Agi, Ago, Agu;
+    word_t Aka, Ake, Aki, Ako, Aku;
+    word_t Ama, Ame, Ami, Amo, Amu;
+    word_t Asa, Ase, Asi, Aso, Asu;
 
-    uint64_t Eba, Ebe, Ebi, Ebo, Ebu;
-    uint64_t Ega, Ege, Egi, Ego, Egu;
-    uint64_t Eka, Eke, Eki, Eko, Eku;
-    uint64_t Ema, Eme, Emi, Emo, Emu;
-    uint64_t Esa, Ese, Esi, Eso, Esu;
+    word_t Eba, Ebe, Ebi, Ebo, Ebu;
+    word_t Ega, Ege, Egi, Ego, Egu;
+    word_t Eka, Eke, Eki, Eko, Eku;
+    word_t Ema, Eme, Emi, Emo, Emu;
+    word_t Esa, Ese, Esi, Eso, Esu;
 
-    uint64_t Ba, Be, Bi, Bo, Bu;
+    word_t Ba, Be, Bi, Bo, Bu;
 
-    uint64_t Da, De, Di, Do, Du;
+    word_t Da, De, Di, Do, Du;
 
     Aba = state[0];
     Abe = state[1];
@@ -102,61 +128,61 @@ static inline ALWAYS_INLINE void keccakf1600_implementation(uint64_t state[25])
         Bo = Abo ^ Ago ^ Ako ^ Amo ^ Aso;
         Bu = Abu ^ Agu ^ Aku ^ Amu ^ Asu;
 
-        Da = Bu ^ crypto::rotl64(Be, 1);
-        De = Ba ^ crypto::rotl64(Bi, 1);
-        Di = Be ^ crypto::rotl64(Bo, 1);
-        Do = Bi ^ crypto::rotl64(Bu, 1);
-        Du = Bo ^ crypto::rotl64(Ba, 1);
+        Da = Bu ^ rotl64(Be, 1);
+        De = Ba ^ rotl64(Bi, 1);
+        Di = Be ^ rotl64(Bo, 1);
+        Do = Bi ^ rotl64(Bu, 1);
+        Du = Bo ^ rotl64(Ba, 1);
 
         Ba = Aba ^ Da;
-        Be = crypto::rotl64(Age ^ De, 44);
-        Bi = crypto::rotl64(Aki ^ Di, 43);
-        Bo = crypto::rotl64(Amo ^ Do, 21);
-        Bu = crypto::rotl64(Asu ^ Du, 14);
+        Be = rotl64(Age ^ De, 44);
+        Bi = rotl64(Aki ^ Di, 43);
+        Bo = rotl64(Amo ^ Do, 21);
+        Bu = rotl64(Asu ^ Du, 14);
         Eba = Ba ^ (~Be & Bi) ^ round_constants_64[n];
         Ebe = Be ^ (~Bi & Bo);
         Ebi = Bi ^ (~Bo & Bu);
         Ebo = Bo ^ (~Bu & Ba);
         Ebu = Bu ^ (~Ba & Be);
 
-        Ba = crypto::rotl64(Abo ^ Do, 28);
-        Be = crypto::rotl64(Agu ^ Du, 20);
-        Bi = crypto::rotl64(Aka ^ Da, 3);
-        Bo = crypto::rotl64(Ame ^ De, 45);
-        Bu = crypto::rotl64(Asi ^ Di, 61);
+        Ba = rotl64(Abo ^ Do, 28);
+        Be = rotl64(Agu ^ Du, 20);
+        Bi = rotl64(Aka ^ Da, 3);
+        Bo = rotl64(Ame ^ De, 45);
+        Bu = rotl64(Asi ^ Di, 61);
         Ega = Ba ^ (~Be & Bi);
         Ege = Be ^ (~Bi & Bo);
         Egi = Bi ^ (~Bo & Bu);
         Ego = Bo ^ (~Bu & Ba);
         Egu = Bu ^ (~Ba & Be);
 
-        Ba = crypto::rotl64(Abe ^ De, 1);
-        Be = crypto::rotl64(Agi ^ Di, 6);
-        Bi = crypto::rotl64(Ako ^ Do, 25);
-        Bo = crypto::rotl64(Amu ^ Du, 8);
-        Bu = crypto::rotl64(Asa ^ Da, 18);
+        Ba = rotl64(Abe ^ De, 1);
+        Be = rotl64(Agi ^ Di, 6);
+        Bi = rotl64(Ako ^ Do, 25);
+        Bo = rotl64(Amu ^ Du, 8);
+        Bu = rotl64(Asa ^ Da, 18);
         Eka = Ba ^ (~Be & Bi);
         Eke = Be ^ (~Bi & Bo);
         Eki = Bi ^ (~Bo & Bu);
         Eko = Bo ^ (~Bu & Ba);
         Eku = Bu ^ (~Ba & Be);
 
-        Ba = crypto::rotl64(Abu ^ Du, 27);
-        Be = crypto::rotl64(Aga ^ Da, 36);
-        Bi = crypto::rotl64(Ake ^ De, 10);
-        Bo = crypto::rotl64(Ami ^ Di, 15);
-        Bu = crypto::rotl64(Aso ^ Do, 56);
+        Ba = rotl64(Abu ^ Du, 27);
+        Be = rotl64(Aga ^ Da, 36);
+        Bi = rotl64(Ake ^ De, 10);
+        Bo = rotl64(Ami ^ Di, 15);
+        Bu = rotl64(Aso ^ Do, 56);
         Ema = Ba ^ (~Be & Bi);
         Eme = Be ^ (~Bi & Bo);
         Emi = Bi ^ (~Bo & Bu);
         Emo = Bo ^ (~Bu & Ba);
         Emu = Bu ^ (~Ba & Be);
 
-        Ba = crypto::rotl64(Abi ^ Di, 62);
-        Be = crypto::rotl64(Ago ^ Do, 55);
-        Bi = crypto::rotl64(Aku ^ Du, 39);
-        Bo = crypto::rotl64(Ama ^ Da, 41);
-        Bu = crypto::rotl64(Ase ^ De, 2);
+        Ba = rotl64(Abi ^ Di, 62);
+        Be = rotl64(Ago ^ Do, 55);
+        Bi = rotl64(Aku ^ Du, 39);
+        Bo = rotl64(Ama ^ Da, 41);
+        Bu = rotl64(Ase ^ De, 2);
         Esa = Ba ^ (~Be & Bi);
         Ese = Be ^ (~Bi & Bo);
         Esi = Bi ^ (~Bo & Bu);
@@ -171,61 +197,61 @@ static inline ALWAYS_INLINE void keccakf1600_implementation(uint64_t state[25])
         Bo = Ebo ^ Ego ^ Eko ^ Emo ^ Eso;
         Bu = Ebu ^ Egu ^ Eku ^ Emu ^ Esu;
 
-        Da = Bu ^ crypto::rotl64(Be, 1);
-        De = Ba ^ crypto::rotl64(Bi, 1);
-        Di = Be ^ crypto::rotl64(Bo, 1);
-        Do = Bi ^ crypto::rotl64(Bu, 1);
-        Du = Bo ^ crypto::rotl64(Ba, 1);
+        Da = Bu ^ rotl64(Be, 1);
+        De = Ba ^ rotl64(Bi, 1);
+        Di = Be ^ rotl64(Bo, 1);
+        Do = Bi ^ rotl64(Bu, 1);
+        Du = Bo ^ rotl64(Ba, 1);
 
         Ba = Eba ^ Da;
-        Be = crypto::rotl64(Ege ^ De, 44);
-        Bi = crypto::rotl64(Eki ^ Di, 43);
-        Bo = crypto::rotl64(Emo ^ Do, 21);
-        Bu = crypto::rotl64(Esu ^ Du, 14);
+        Be = rotl64(Ege ^ De, 44);
+        Bi = rotl64(Eki ^ Di, 43);
+        Bo = rotl64(Emo ^ Do, 21);
+        Bu = rotl64(Esu ^ Du, 14);
         Aba = Ba ^ (~Be & Bi) ^ round_constants_64[n + 1];
         Abe = Be ^ (~Bi & Bo);
         Abi = Bi ^ (~Bo & Bu);
         Abo = Bo ^ (~Bu & Ba);
         Abu = Bu ^ (~Ba & Be);
 
-        Ba = crypto::rotl64(Ebo ^ Do, 28);
-        Be = crypto::rotl64(Egu ^ Du, 20);
-        Bi = crypto::rotl64(Eka ^ Da, 3);
-        Bo = crypto::rotl64(Eme ^ De, 45);
-        Bu = crypto::rotl64(Esi ^ Di, 61);
+        Ba = rotl64(Ebo ^ Do, 28);
+        Be = rotl64(Egu ^ Du, 20);
+        Bi = rotl64(Eka ^ Da, 3);
+        Bo = rotl64(Eme ^ De, 45);
+        Bu = rotl64(Esi ^ Di, 61);
         Aga = Ba ^ (~Be & Bi);
         Age = Be ^ (~Bi & Bo);
         Agi = Bi ^ (~Bo & Bu);
         Ago = Bo ^ (~Bu & Ba);
         Agu = Bu ^ (~Ba & Be);
 
-        Ba = crypto::rotl64(Ebe ^ De, 1);
-        Be = crypto::rotl64(Egi ^ Di, 6);
-        Bi = crypto::rotl64(Eko ^ Do, 25);
-        Bo = crypto::rotl64(Emu ^ Du, 8);
-        Bu = crypto::rotl64(Esa ^ Da, 18);
+        Ba = rotl64(Ebe ^ De, 1);
+        Be = rotl64(Egi ^ Di, 6);
+        Bi = rotl64(Eko ^ Do, 25);
+        Bo = rotl64(Emu ^ Du, 8);
+        Bu = rotl64(Esa ^ Da, 18);
         Aka = Ba ^ (~Be & Bi);
         Ake = Be ^ (~Bi & Bo);
         Aki = Bi ^ (~Bo & Bu);
         Ako = Bo ^ (~Bu & Ba);
         Aku = Bu ^ (~Ba & Be);
 
-        Ba = crypto::rotl64(Ebu ^ Du, 27);
-        Be = crypto::rotl64(Ega ^ Da, 36);
-        Bi = crypto::rotl64(Eke ^ De, 10);
-        Bo = crypto::rotl64(Emi ^ Di, 15);
-        Bu = crypto::rotl64(Eso ^ Do, 56);
+        Ba = rotl64(Ebu ^ Du, 27);
+        Be = rotl64(Ega ^ Da, 36);
+        Bi = rotl64(Eke ^ De, 10);
+        Bo = rotl64(Emi ^ Di, 15);
+        Bu = rotl64(Eso ^ Do, 56);
         Ama = Ba ^ (~Be & Bi);
         Ame = Be ^ (~Bi & Bo);
         Ami = Bi ^ (~Bo & Bu);
         Amo = Bo ^ (~Bu & Ba);
         Amu = Bu ^ (~Ba & Be);
 
-        Ba = crypto::rotl64(Ebi ^ Di, 62);
-        Be = crypto::rotl64(Ego ^ Do, 55);
-        Bi = crypto::rotl64(Eku ^ Du, 39);
-        Bo = crypto::rotl64(Ema ^ Da, 41);
-        Bu = crypto::rotl64(Ese ^ De, 2);
+        Ba = rotl64(Ebi ^ Di, 62);
+        Be = rotl64(Ego ^ Do, 55);
+        Bi = rotl64(Eku ^ Du, 39);
+        Bo = rotl64(Ema ^ Da, 41);
+        Bu = rotl64(Ese ^ De, 2);
         Asa = Ba ^ (~Be & Bi);
         Ase = Be ^ (~Bi & Bo);
         Asi = Bi ^ (~Bo & Bu);
@@ -481,64 +507,124 @@ static void keccakf1600_generic(uint64_t state[25])
 }
 
 /// The pointer to the best Keccak-f[1600] function implementation,
-/// selected during runtime initialization.
+/// selected during runtime initialization (see dispatch.hpp).
 static void (*keccakf1600_best)(uint64_t[25]) = keccakf1600_generic;
 
-#if defined(__x86_64__) && __has_attribute(target)
-__attribute__((target("bmi,bmi2"))) static void keccakf1600_bmi(uint64_t state[25])
+void keccakf1600(uint64_t state[25])
 {
-    keccakf1600_implementation(state);
+    keccakf1600_best(state);
 }
 
-__attribute__((constructor)) static void select_keccakf1600_implementation()
+static void keccakf800_generic(uint32_t state[25])
 {
-    // Init CPU information.
-    // This is needed on macOS because of the bug: https://bugs.llvm.org/show_bug.cgi?id=48459.
-    __builtin_cpu_init();
+    keccakf800_implementation(state);
+}
 
-    // Check if both BMI and BMI2 are supported. Some CPUs like Intel E5-2697 v2 incorrectly
-    // report BMI2 but not BMI being available.
-    if (__builtin_cpu_supports("bmi") && __builtin_cpu_supports("bmi2"))
-        keccakf1600_best = keccakf1600_bmi;
+/// The pointer to the best Keccak-f[800] function implementation,
+/// selected during runtime initialization (see dispatch.hpp).
+static void (*keccakf800_best)(uint32_t[25]) = keccakf800_generic;
+
+void keccakf800(uint32_t state[25])
+{
+    keccakf800_best(state);
 }
-#endif
 
-void keccakf1600(uint64_t state[25])
+static void keccak512_x4_generic(hash512 out[4], const hash512 in[4])
 {
-    keccakf1600_best(state);
+    for (size_t i{0}; i < 4; ++i)
+        out[i] = keccak512(in[i]);
 }
 
-static void keccakf800_generic(uint32_t state[25])
+/// The pointer to the best 4-way keccak512 implementation,
+/// selected during runtime initialization (see dispatch.hpp).
+static void (*keccak512_x4_best)(hash512[4], const hash512[4]) = keccak512_x4_generic;
+
+static void keccak512_x8_generic(hash512 out[8], const hash512 in[8])
 {
-    keccakf800_implementation(state);
+    keccak512_x4_best(&out[0], &in[0]);
+    keccak512_x4_best(&out[4], &in[4]);
 }
 
-/// The pointer to the best Keccak-f[1600] function implementation,
-/// selected during runtime initialization.
-static void (*keccakf800_best)(uint32_t[25]) = keccakf800_generic;
+/// The pointer to the best 8-way keccak512 implementation,
+/// selected during runtime initialization (see dispatch.hpp).
+static void (*keccak512_x8_best)(hash512[8], const hash512[8]) = keccak512_x8_generic;
+
+#if HAVE_X86_TARGET_DISPATCH
+// The permutations are scalar code: the sse4 tier brings nothing to them while
+// BMI/BMI2 (andn, rorx) come with the avx2 tier.
+ATTRIBUTE_TARGET("bmi,bmi2") static void keccakf1600_bmi(uint64_t state[25])
+{
+    keccakf1600_implementation(state);
+}
 
-#if defined(__x86_64__) && __has_attribute(target)
-__attribute__((target("bmi,bmi2"))) static void keccakf800_bmi(uint32_t state[25])
+ATTRIBUTE_TARGET("bmi,bmi2") static void keccakf800_bmi(uint32_t state[25])
 {
     keccakf800_implementation(state);
 }
 
-__attribute__((constructor)) static void select_keccakf800_implementation()
+/// Keccak-512 of N 64-byte messages with the N states interleaved lane by lane.
+/// A 64-byte message fits in a single 72-byte block so one permutation is enough:
+/// the message fills words 0..7 and the padding (0x01 ... 0x80) lands in word 8.
+template <typename word_t, size_t N>
+static inline ALWAYS_INLINE void keccak512_interleaved(hash512 out[N], const hash512 in[N])
 {
-    // Init CPU information.
-    // This is needed on macOS because of the bug: https://bugs.llvm.org/show_bug.cgi?id=48459.
-    __builtin_cpu_init();
+    word_t state[25]{};
+    for (size_t i{0}; i < 8; ++i)
+    {
+        for (size_t j{0}; j < N; ++j)
+            state[i][j] = le::uint64(in[j].word64s[i]);
+    }
+    state[8] ^= 0x8000000000000001;
 
-    // Check if both BMI and BMI2 are supported. Some CPUs like Intel E5-2697 v2 incorrectly
-    // report BMI2 but not BMI being available.
-    if (__builtin_cpu_supports("bmi") && __builtin_cpu_supports("bmi2"))
-        keccakf800_best = keccakf800_bmi;
+    keccakf1600_implementation(state);
+
+    for (size_t i{0}; i < 8; ++i)
+    {
+        for (size_t j{0}; j < N; ++j)
+            out[j].word64s[i] = le::uint64(state[i][j]);
+    }
+}
+
+ATTRIBUTE_TARGET("avx2") static void keccak512_x4_avx2(hash512 out[4], const hash512 in[4])
+{
+    keccak512_interleaved<uint64x4_t, 4>(out, in);
+}
+
+ATTRIBUTE_TARGET("avx512f") static void keccak512_x8_avx512(hash512 out[8], const hash512 in[8])
+{
+    keccak512_interleaved<uint64x8_t, 8>(out, in);
 }
 #endif
 
-void keccakf800(uint32_t state[25])
+static void select_kernels(crypto::simd_level level) noexcept
 {
-    keccakf800_best(state);
+    keccakf1600_best = keccakf1600_generic;
+    keccakf800_best = keccakf800_generic;
+    keccak512_x4_best = keccak512_x4_generic;
+    keccak512_x8_best = keccak512_x8_generic;
+
+#if HAVE_X86_TARGET_DISPATCH
+    if (level >= crypto::simd_level::avx2)
+    {
+        keccakf1600_best = keccakf1600_bmi;
+        keccakf800_best = keccakf800_bmi;
+        keccak512_x4_best = keccak512_x4_avx2;
+    }
+    if (level >= crypto::simd_level::avx512)
+        keccak512_x8_best = keccak512_x8_avx512;
+#else
+    (void)level;
+#endif
+}
+
+void keccak512_x4(hash512 out[4], const hash512 in[4])
+{
+    keccak512_x4_best(out, in);
+}
+
+void keccak512_x8(hash512 out[8], const hash512 in[8])
+{
+    keccak512_x8_best(out, in);
 }
 
 static inline ALWAYS_INLINE void keccak(
@@ -618,3 +704,8 @@ hash512 keccak512(const hash512& input)
 }
 
 }  // namespace ethash
+
+void crypto::detail::select_keccak_kernels(simd_level level) noexcept
+{
+    ethash::select_kernels(level);
+}
@@ -27,6 +27,16 @@ hash256 keccak256(const uint8_t* input, size_t input_size);
 hash512 keccak512(const hash512& input);
 hash512 keccak512(const uint8_t* input, size_t input_size);
 
+/**
+ * Computes keccak512 of 4 (or 8) independent 64-byte inputs side by side.
+ *
+ * The sponge states are interleaved so a single AVX2 (AVX-512) permutation
+ * serves all of them. Falls back to sequential keccak512 when the CPU lacks
+ * the instruction set. `out` may alias `in`.
+ */
+void keccak512_x4(hash512 out[4], const hash512 in[4]);
+void keccak512_x8(hash512 out[8], const hash512 in[8]);
+
 }  // namespace ethash
 
 #endif  // !CRYPTO_KECCAK_HPP_
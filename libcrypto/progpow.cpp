@@ -6,6 +6,14 @@
 
 #include "progpow.hpp"
 #include "bitwise.hpp"
+#include "dispatch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace progpow
 {
@@ -36,6 +44,82 @@ mix_rng_state::mix_rng_state(uint64_t seed) noexcept
     }
 }
 
+program::program(uint64_t period_) noexcept : period{period_}
+{
+    // Same draws, in the same order, as the kernels generated by getKern()
+    mix_rng_state state{period};
+    for (uint32_t i{0}; i < std::max(kCache_count, kMath_count); ++i)
+    {
+        if (i < kCache_count)
+        {
+            auto& op{cache_ops[i]};
+            op.src = state.next_src();
+            op.dst = state.next_dst();
+            op.sel = state.rng();
+        }
+        if (i < kMath_count)
+        {
+            // Generate 2 unique source indexes.
+            auto& op{math_ops[i]};
+            const auto src_rnd{state.rng() % (kRegs * (kRegs - 1))};
+            op.src1 = src_rnd % kRegs;  // O <= src1 < num_regs
+            op.src2 = src_rnd / kRegs;  // 0 <= src2 < num_regs - 1
+            if (op.src2 >= op.src1)
+            {
+                ++op.src2;
+            }
+            op.sel1 = state.rng();
+            op.dst = state.next_dst();
+            op.sel2 = state.rng();
+        }
+    }
+
+    for (uint32_t i{0}; i < kWords_per_lane; ++i)
+    {
+        dag_dsts[i] = (i == 0 ? 0 : state.next_dst());
+        dag_sels[i] = state.rng();
+    }
+}
+
+// Programs of the last few periods. A solution for the previous period may
+// still be verified while mining the current one.
+static constexpr size_t kProgram_cache_size{4};
+static std::mutex program_cache_mutex;
+static std::array<std::shared_ptr<const program>, kProgram_cache_size> program_cache;
+static size_t program_cache_next{0};
+
+std::shared_ptr<const program> get_program(uint64_t period)
+{
+    std::lock_guard<std::mutex> lock{program_cache_mutex};
+    for (const auto& cached : program_cache)
+    {
+        if (cached && cached->period == period)
+            return cached;
+    }
+
+    // Compiling is cheap so it's done under the lock. Replaces the oldest one.
+    auto compiled{std::make_shared<const program>(period)};
+    program_cache[program_cache_next] = compiled;
+    program_cache_next = (program_cache_next + 1) % kProgram_cache_size;
+    return compiled;
+}
+
+/// Replaces the cached program of a period, or caches it if not there
+static void replace_program(std::shared_ptr<const program> prog)
+{
+    std::lock_guard<std::mutex> lock{program_cache_mutex};
+    for (auto& cached : program_cache)
+    {
+        if (cached && cached->period == prog->period)
+        {
+            cached = std::move(prog);
+            return;
+        }
+    }
+    program_cache[program_cache_next] = std::move(prog);
+    program_cache_next = (program_cache_next + 1) % kProgram_cache_size;
+}
+
 NO_SANITIZE("unsigned-integer-overflow")
 static void random_merge(uint32_t& a, uint32_t b, uint32_t sel) noexcept
 {
@@ -139,8 +223,72 @@ static std::string random_math_src(std::string d, std::string a, std::string b,
     return "#error\n";
 }
 
+// Source of the C++ kernel: the program loop over the register major mix of all lanes,
+// each step a loop over lanes for the host compiler to vectorize
+static std::string cpu_kernel_source(uint64_t prog_seed)
+{
+    const program prog{prog_seed};
+    const std::string for_lanes{"for (uint32_t l = 0; l < PROGPOW_LANES; l++)\n    "};
+    auto reg = [](uint32_t r) { return "mix[" + std::to_string(r) + "][l]"; };
+
+    std::stringstream ret;
+    ret << "#include <stdint.h>\n";
+    ret << "static inline uint32_t ROTL32(uint32_t x, uint32_t n) { n %= 32; return n ? (x << n) | (x >> (32 - n)) : x; }\n";
+    ret << "static inline uint32_t ROTR32(uint32_t x, uint32_t n) { n %= 32; return n ? (x >> n) | (x << (32 - n)) : x; }\n";
+    ret << "static inline uint32_t min(uint32_t a, uint32_t b) { return a < b ? a : b; }\n";
+    ret << "static inline uint32_t mul_hi(uint32_t a, uint32_t b) { return (uint32_t)(((uint64_t)a * b) >> 32); }\n";
+    ret << "static inline uint32_t clz(uint32_t a) { return a ? (uint32_t)__builtin_clz(a) : 32u; }\n";
+    ret << "static inline uint32_t popcount(uint32_t a) { return (uint32_t)__builtin_popcount(a); }\n";
+    ret << "\n";
+    ret << "#define PROGPOW_LANES           " << kLanes << "\n";
+    ret << "#define PROGPOW_REGS            " << kRegs << "\n";
+    ret << "#define PROGPOW_DAG_LOADS       " << kDag_loads << "\n";
+    ret << "#define PROGPOW_CACHE_WORDS     " << kCache_bytes / sizeof(uint32_t) << "\n";
+    ret << "\n";
+    ret << "// Inner loop for prog_seed " << prog_seed << "\n";
+    ret << "extern \"C\" void progPowLoop(const uint32_t loop,\n";
+    ret << "        uint32_t mix[PROGPOW_REGS][PROGPOW_LANES],\n";
+    ret << "        const uint32_t* dag_item,\n";
+    ret << "        const uint32_t* c_dag)\n";
+    ret << "{\n";
+    ret << "uint32_t data[PROGPOW_LANES];\n";
+
+    for (uint32_t i = 0; (i < kCache_count) || (i < kMath_count); i++)
+    {
+        if (i < kCache_count)
+        {
+            const auto& op{prog.cache_ops[i]};
+            ret << "// cache load " << i << "\n";
+            ret << for_lanes << "data[l] = c_dag[" << reg(op.src) << " % PROGPOW_CACHE_WORDS];\n";
+            ret << for_lanes << random_merge_src(reg(op.dst), "data[l]", op.sel);
+        }
+        if (i < kMath_count)
+        {
+            const auto& op{prog.math_ops[i]};
+            ret << "// random math " << i << "\n";
+            ret << for_lanes << random_math_src("data[l]", reg(op.src1), reg(op.src2), op.sel1);
+            ret << for_lanes << random_merge_src(reg(op.dst), "data[l]", op.sel2);
+        }
+    }
+
+    // Lane l consumes the words of the item at (l ^ loop) % PROGPOW_LANES
+    ret << "// consume global load data\n";
+    ret << "for (uint32_t l = 0; l < PROGPOW_LANES; l++)\n";
+    ret << "{\n";
+    ret << "const uint32_t* data_dag = dag_item + ((l ^ loop) % PROGPOW_LANES) * PROGPOW_DAG_LOADS;\n";
+    for (uint32_t i = 0; i < kDag_loads; i++)
+        ret << random_merge_src(reg(prog.dag_dsts[i]), "data_dag[" + std::to_string(i) + "]", prog.dag_sels[i]);
+    ret << "}\n";
+    ret << "}\n";
+
+    return ret.str();
+}
+
 std::string getKern(uint64_t prog_seed, kernel_type kern)
 {
+    if (kern == kernel_type::Cpu)
+        return cpu_kernel_source(prog_seed);
+
     std::stringstream ret;
     mix_rng_state state{prog_seed};
 
@@ -333,14 +481,17 @@ std::string getKern(uint64_t prog_seed, kernel_type kern)
 
 using mix_t = std::array<std::array<uint32_t, kRegs>, kLanes>;
 
-static void round(const ethash::epoch_context& context, uint32_t r, mix_t& mix, mix_rng_state state)
+/// One round of the lane by lane reference implementation.
+template <bool Full>
+static void round(const ethash::epoch_context& context, uint32_t r, mix_t& mix, const program& prog)
 {
     static const uint32_t l1_cache_words{ethash::kL1_cache_size / sizeof(uint32_t)};
     const uint32_t num_items{static_cast<uint32_t>(context.full_dataset_num_items / 2)};
     const uint32_t item_index{mix.at(r % kLanes).at(0) % num_items};
 
-    // Load DAG Data
-    ethash::hash2048 item{ethash::detail::lazy_lookup_2048(context, item_index)};
+    // Load DAG Data. A full dataset is always completely built thus a plain load
+    const ethash::hash2048 item{Full ? reinterpret_cast<const ethash::hash2048*>(context.full_dataset)[item_index] :
+                                       ethash::detail::lazy_lookup_2048(context, item_index)};
 
     const auto max_operations{std::max(kCache_count, kMath_count)};
 
@@ -349,48 +500,24 @@ static void round(const ethash::epoch_context& context, uint32_t r, mix_t& mix,
     {
         if (i < kCache_count)  // Random access to cached memory.
         {
-            const auto src{state.next_src()};
-            const auto dst{state.next_dst()};
-            const auto sel{state.rng()};
-
+            const auto& op{prog.cache_ops[i]};
             for (uint64_t l{0}; l < kLanes; ++l)
             {
-                const size_t offset = mix.at(l).at(src) % ethash::kL1_cache_words;
-                random_merge(mix.at(l).at(dst), ethash::le::uint32(context.l1_cache[offset]), sel);
+                const size_t offset = mix.at(l).at(op.src) % ethash::kL1_cache_words;
+                random_merge(mix.at(l).at(op.dst), ethash::le::uint32(context.l1_cache[offset]), op.sel);
             }
         }
         if (i < kMath_count)  // Random math.
         {
-            // Generate 2 unique source indexes.
-            const auto src_rnd{state.rng() % (kRegs * (kRegs - 1))};
-            const auto src1{src_rnd % kRegs};  // O <= src1 < num_regs
-            auto src2{src_rnd / kRegs};        // 0 <= src2 < num_regs - 1
-            if (src2 >= src1)
-            {
-                ++src2;
-            }
-
-            const auto sel1{state.rng()};
-            const auto dst{state.next_dst()};
-            const auto sel2{state.rng()};
-
+            const auto& op{prog.math_ops[i]};
             for (uint64_t l{0}; l < kLanes; ++l)
             {
-                const uint32_t data = random_math(mix.at(l).at(src1), mix.at(l).at(src2), sel1);
-                random_merge(mix.at(l).at(dst), data, sel2);
+                const uint32_t data = random_math(mix.at(l).at(op.src1), mix.at(l).at(op.src2), op.sel1);
+                random_merge(mix.at(l).at(op.dst), data, op.sel2);
             }
         }
     }
 
-    // Dag Access pattern
-    uint32_t dsts[kWords_per_lane];
-    uint32_t sels[kWords_per_lane];
-    for (size_t i = 0; i < kWords_per_lane; i++)
-    {
-        dsts[i] = (i == 0 ? 0 : state.next_dst());
-        sels[i] = state.rng();
-    }
-
     // Dag access
     for (size_t l = 0; l < kLanes; l++)
     {
@@ -398,11 +525,414 @@ static void round(const ethash::epoch_context& context, uint32_t r, mix_t& mix,
         for (size_t i = 0; i < kWords_per_lane; i++)
         {
             const auto word = ethash::le::uint32(item.word32s[offset + i]);
-            random_merge(mix.at(l).at(dsts[i]), word, sels[i]);
+            random_merge(mix.at(l).at(prog.dag_dsts[i]), word, prog.dag_sels[i]);
         }
     }
 }
 
+// Register major (SoA) mix: the words of all lanes for a register are contiguous.
+// All lanes run the same program in lockstep, so every step is a loop over 16 lanes
+// which vectorizes into one 512-bit or two 256-bit operations.
+struct alignas(64) lane_words
+{
+    uint32_t lanes[kLanes];
+};
+
+using soa_mix_t = std::array<lane_words, kRegs>;
+
+NO_SANITIZE("unsigned-integer-overflow")
+static inline ALWAYS_INLINE void merge_lanes(lane_words& a, const lane_words& b, uint32_t sel) noexcept
+{
+    const auto x = (sel >> 16) % 31 + 1;  // Additional non-zero selector from higher bits.
+    switch (sel % 4)
+    {
+    case 0:
+        for (uint32_t l{0}; l < kLanes; ++l)
+            a.lanes[l] = (a.lanes[l] * 33) + b.lanes[l];
+        return;
+    case 1:
+        for (uint32_t l{0}; l < kLanes; ++l)
+            a.lanes[l] = (a.lanes[l] ^ b.lanes[l]) * 33;
+        return;
+    case 2:
+        for (uint32_t l{0}; l < kLanes; ++l)
+            a.lanes[l] = crypto::rotl32(a.lanes[l], x) ^ b.lanes[l];
+        return;
+    case 3:
+        for (uint32_t l{0}; l < kLanes; ++l)
+            a.lanes[l] = crypto::rotr32(a.lanes[l], x) ^ b.lanes[l];
+        return;
+    }
+}
+
+NO_SANITIZE("unsigned-integer-overflow")
+static inline ALWAYS_INLINE void math_lanes(
+    lane_words& d, const lane_words& a, const lane_words& b, uint32_t sel) noexcept
+{
+    switch (sel % 11)
+    {
+    case 0:
+        for (uint32_t l{0}; l < kLanes; ++l)
+            d.lanes[l] = a.lanes[l] + b.lanes[l];
+        return;
+    case 1:
+        for (uint32_t l{0}; l < kLanes; ++l)
+            d.lanes[l] = a.lanes[l] * b.lanes[l];
+        return;
+    case 2:
+        for (uint32_t l{0}; l < kLanes; ++l)
+            d.lanes[l] = crypto::mul_hi32(a.lanes[l], b.lanes[l]);
+        return;
+    case 3:
+        for (uint32_t l{0}; l < kLanes; ++l)
+            d.lanes[l] = std::min(a.lanes[l], b.lanes[l]);
+        return;
+    case 4:
+        for (uint32_t l{0}; l < kLanes; ++l)
+            d.lanes[l] = crypto::rotl32(a.lanes[l], b.lanes[l]);
+        return;
+    case 5:
+        for (uint32_t l{0}; l < kLanes; ++l)
+            d.lanes[l] = crypto::rotr32(a.lanes[l], b.lanes[l]);
+        return;
+    case 6:
+        for (uint32_t l{0}; l < kLanes; ++l)
+            d.lanes[l] = a.lanes[l] & b.lanes[l];
+        return;
+    case 7:
+        for (uint32_t l{0}; l < kLanes; ++l)
+            d.lanes[l] = a.lanes[l] | b.lanes[l];
+        return;
+    case 8:
+        for (uint32_t l{0}; l < kLanes; ++l)
+            d.lanes[l] = a.lanes[l] ^ b.lanes[l];
+        return;
+    case 9:
+        for (uint32_t l{0}; l < kLanes; ++l)
+            d.lanes[l] = crypto::clz32(a.lanes[l]) + crypto::clz32(b.lanes[l]);
+        return;
+    default: /* 10 */
+        for (uint32_t l{0}; l < kLanes; ++l)
+            d.lanes[l] = crypto::popcnt32(a.lanes[l]) + crypto::popcnt32(b.lanes[l]);
+        return;
+    }
+}
+
+/// The program of round r on the register major mix, its DAG item being loaded.
+static inline ALWAYS_INLINE void run_program(
+    uint32_t r, soa_mix_t& mix, const uint32_t dag_item[], const uint32_t l1_cache[], const program& prog)
+{
+    const auto max_operations{std::max(kCache_count, kMath_count)};
+    lane_words data;
+
+    for (unsigned i = 0; i < max_operations; ++i)
+    {
+        if (i < kCache_count)  // Random access to cached memory, a gather across lanes.
+        {
+            const auto& op{prog.cache_ops[i]};
+            const lane_words& src{mix[op.src]};
+            for (uint32_t l{0}; l < kLanes; ++l)
+                data.lanes[l] = ethash::le::uint32(l1_cache[src.lanes[l] % ethash::kL1_cache_words]);
+            merge_lanes(mix[op.dst], data, op.sel);
+        }
+        if (i < kMath_count)  // Random math.
+        {
+            const auto& op{prog.math_ops[i]};
+            math_lanes(data, mix[op.src1], mix[op.src2], op.sel1);
+            merge_lanes(mix[op.dst], data, op.sel2);
+        }
+    }
+
+    // Dag access
+    for (size_t i = 0; i < kWords_per_lane; i++)
+    {
+        for (uint32_t l{0}; l < kLanes; ++l)
+            data.lanes[l] = ethash::le::uint32(dag_item[((l ^ r) % kLanes) * kWords_per_lane + i]);
+        merge_lanes(mix[prog.dag_dsts[i]], data, prog.dag_sels[i]);
+    }
+}
+
+/// Same as round() on the register major mix.
+template <bool Full>
+static inline ALWAYS_INLINE void round_lanes(
+    const ethash::epoch_context& context, uint32_t r, soa_mix_t& mix, const program& prog)
+{
+    const uint32_t num_items{static_cast<uint32_t>(context.full_dataset_num_items / 2)};
+    const uint32_t item_index{mix[0].lanes[r % kLanes] % num_items};
+
+    // Load DAG Data. A full dataset is always completely built thus a plain load
+    const ethash::hash2048 item{Full ? reinterpret_cast<const ethash::hash2048*>(context.full_dataset)[item_index] :
+                                       ethash::detail::lazy_lookup_2048(context, item_index)};
+
+    run_program(r, mix, item.word32s, context.l1_cache, prog);
+}
+
+static void to_lanes(const mix_t& mix, soa_mix_t& soa_mix) noexcept
+{
+    for (uint32_t l{0}; l < kLanes; ++l)
+    {
+        for (uint32_t i{0}; i < kRegs; ++i)
+            soa_mix[i].lanes[l] = mix[l][i];
+    }
+}
+
+static void from_lanes(const soa_mix_t& soa_mix, mix_t& mix) noexcept
+{
+    for (uint32_t l{0}; l < kLanes; ++l)
+    {
+        for (uint32_t i{0}; i < kRegs; ++i)
+            mix[l][i] = soa_mix[i].lanes[l];
+    }
+}
+
+static uint32_t (*native_mix(soa_mix_t& soa_mix) noexcept)[kLanes]
+{
+    return reinterpret_cast<uint32_t(*)[kLanes]>(soa_mix.data());
+}
+
+/// Runs all the DAG rounds of a mix on the register major layout. The lane loops are
+/// what the compiler vectorizes, so this is built for every instruction set tier and
+/// picked at runtime (see dispatch.hpp).
+template <bool Full>
+static inline ALWAYS_INLINE void mix_rounds(const ethash::epoch_context& context, const program& prog, mix_t& mix)
+{
+    soa_mix_t soa_mix;
+    to_lanes(mix, soa_mix);
+    for (uint32_t i{0}; i < kDag_count; ++i)
+    {
+        round_lanes<Full>(context, i, soa_mix, prog);
+    }
+    from_lanes(soa_mix, mix);
+}
+
+/// Runs all the DAG rounds of a mix with the native loop of the program. Only the
+/// DAG loads are left to the host.
+template <bool Full>
+static void mix_rounds_native(const ethash::epoch_context& context, const program& prog, mix_t& mix)
+{
+    const uint32_t num_items{static_cast<uint32_t>(context.full_dataset_num_items / 2)};
+
+    soa_mix_t soa_mix;
+    to_lanes(mix, soa_mix);
+    for (uint32_t r{0}; r < kDag_count; ++r)
+    {
+        const uint32_t item_index{soa_mix[0].lanes[r % kLanes] % num_items};
+        const ethash::hash2048 item{Full ?
+                                        reinterpret_cast<const ethash::hash2048*>(context.full_dataset)[item_index] :
+                                        ethash::detail::lazy_lookup_2048(context, item_index)};
+        prog.native_loop(r, native_mix(soa_mix), item.word32s, context.l1_cache);
+    }
+    from_lanes(soa_mix, mix);
+}
+
+namespace detail
+{
+bool install_native_loop(uint64_t period, program::native_loop_fn loop, std::shared_ptr<void> module)
+{
+#if __BYTE_ORDER != __LITTLE_ENDIAN
+    // Native loops read the DAG words as they are
+    (void)period;
+    (void)loop;
+    (void)module;
+    return false;
+#else
+    auto prog{std::make_shared<program>(*get_program(period))};
+
+    // Run all the rounds of both on random mix, DAG items and cache
+    crypto::kiss99 rng{static_cast<uint32_t>(period), static_cast<uint32_t>(period >> 32), 0x9e3779b9, 0x7f4a7c15};
+    std::vector<uint32_t> l1_cache(ethash::kL1_cache_words);
+    for (auto& word : l1_cache)
+        word = rng();
+    soa_mix_t expected;
+    for (auto& reg : expected)
+    {
+        for (auto& word : reg.lanes)
+            word = rng();
+    }
+    soa_mix_t actual{expected};
+
+    for (uint32_t r{0}; r < kDag_count; ++r)
+    {
+        uint32_t dag_item[kLanes * kWords_per_lane];
+        for (auto& word : dag_item)
+            word = rng();
+        run_program(r, expected, dag_item, l1_cache.data(), *prog);
+        loop(r, native_mix(actual), dag_item, l1_cache.data());
+    }
+    for (uint32_t i{0}; i < kRegs; ++i)
+    {
+        if (std::memcmp(expected[i].lanes, actual[i].lanes, sizeof(lane_words)) != 0)
+            return false;
+    }
+
+    prog->native_loop = loop;
+    prog->native_module = std::move(module);
+    replace_program(std::move(prog));
+    return true;
+#endif
+}
+}  // namespace detail
+
+template <bool Full>
+static void mix_rounds_generic(const ethash::epoch_context& context, const program& prog, mix_t& mix)
+{
+    mix_rounds<Full>(context, prog, mix);
+}
+
+#if HAVE_X86_TARGET_DISPATCH
+template <bool Full>
+ATTRIBUTE_TARGET("sse4.1,sse4.2")
+static void mix_rounds_sse4(const ethash::epoch_context& context, const program& prog, mix_t& mix)
+{
+    mix_rounds<Full>(context, prog, mix);
+}
+
+template <bool Full>
+ATTRIBUTE_TARGET("avx2,bmi,bmi2")
+static void mix_rounds_avx2(const ethash::epoch_context& context, const program& prog, mix_t& mix)
+{
+    mix_rounds<Full>(context, prog, mix);
+}
+
+template <bool Full>
+ATTRIBUTE_TARGET("avx512f,avx2,bmi,bmi2")
+static void mix_rounds_avx512(const ethash::epoch_context& context, const program& prog, mix_t& mix)
+{
+    mix_rounds<Full>(context, prog, mix);
+}
+#endif
+
+using mix_rounds_fn = void (*)(const ethash::epoch_context&, const program&, mix_t&);
+
+// Indexed by whether the context has a full dataset
+template <bool Full>
+static mix_rounds_fn mix_rounds_best = mix_rounds_generic<Full>;
+
+template <bool Full>
+static void select_mix_rounds(crypto::simd_level level) noexcept
+{
+    mix_rounds_best<Full> = mix_rounds_generic<Full>;
+#if HAVE_X86_TARGET_DISPATCH
+    if (level >= crypto::simd_level::avx512)
+        mix_rounds_best<Full> = mix_rounds_avx512<Full>;
+    else if (level >= crypto::simd_level::avx2)
+        mix_rounds_best<Full> = mix_rounds_avx2<Full>;
+    else if (level >= crypto::simd_level::sse4)
+        mix_rounds_best<Full> = mix_rounds_sse4<Full>;
+#else
+    (void)level;
+#endif
+}
+
+/// Prefetches the 4 cache lines of a 2048-bit DAG item.
+static inline ALWAYS_INLINE void prefetch_item(const ethash::hash2048& item) noexcept
+{
+    const auto* const p{reinterpret_cast<const char*>(&item)};
+    for (size_t line{0}; line < sizeof(item); line += 64)
+        PREFETCH(p + line);
+}
+
+/// The rounds of several nonces interleaved. Once the program of a round of a nonce
+/// has run, the DAG item of its next round is known and prefetched, so the DAG misses
+/// of all nonces are in flight while the programs of the others run.
+template <bool Full>
+static inline ALWAYS_INLINE void mix_rounds_batch(
+    const ethash::epoch_context& context, const program& prog, soa_mix_t mixes[], size_t count)
+{
+    const uint32_t num_items{static_cast<uint32_t>(context.full_dataset_num_items / 2)};
+    const auto* const items{reinterpret_cast<const ethash::hash2048*>(context.full_dataset)};
+    uint32_t item_indexes[kMax_nonces_in_flight];
+
+    for (size_t k{0}; k < count; ++k)
+    {
+        item_indexes[k] = mixes[k][0].lanes[0] % num_items;
+        if constexpr (Full)
+            prefetch_item(items[item_indexes[k]]);
+    }
+
+    for (uint32_t r{0}; r < kDag_count; ++r)
+    {
+        for (size_t k{0}; k < count; ++k)
+        {
+            const ethash::hash2048 item{
+                Full ? items[item_indexes[k]] : ethash::detail::lazy_lookup_2048(context, item_indexes[k])};
+            if (prog.native_loop)
+                prog.native_loop(r, native_mix(mixes[k]), item.word32s, context.l1_cache);
+            else
+                run_program(r, mixes[k], item.word32s, context.l1_cache, prog);
+
+            if (r + 1 < kDag_count)
+            {
+                item_indexes[k] = mixes[k][0].lanes[(r + 1) % kLanes] % num_items;
+                if constexpr (Full)
+                    prefetch_item(items[item_indexes[k]]);
+            }
+        }
+    }
+}
+
+template <bool Full>
+static void mix_rounds_batch_generic(
+    const ethash::epoch_context& context, const program& prog, soa_mix_t mixes[], size_t count)
+{
+    mix_rounds_batch<Full>(context, prog, mixes, count);
+}
+
+#if HAVE_X86_TARGET_DISPATCH
+template <bool Full>
+ATTRIBUTE_TARGET("sse4.1,sse4.2")
+static void mix_rounds_batch_sse4(
+    const ethash::epoch_context& context, const program& prog, soa_mix_t mixes[], size_t count)
+{
+    mix_rounds_batch<Full>(context, prog, mixes, count);
+}
+
+template <bool Full>
+ATTRIBUTE_TARGET("avx2,bmi,bmi2")
+static void mix_rounds_batch_avx2(
+    const ethash::epoch_context& context, const program& prog, soa_mix_t mixes[], size_t count)
+{
+    mix_rounds_batch<Full>(context, prog, mixes, count);
+}
+
+template <bool Full>
+ATTRIBUTE_TARGET("avx512f,avx2,bmi,bmi2")
+static void mix_rounds_batch_avx512(
+    const ethash::epoch_context& context, const program& prog, soa_mix_t mixes[], size_t count)
+{
+    mix_rounds_batch<Full>(context, prog, mixes, count);
+}
+#endif
+
+using mix_rounds_batch_fn = void (*)(const ethash::epoch_context&, const program&, soa_mix_t[], size_t);
+
+// Indexed by whether the context has a full dataset
+template <bool Full>
+static mix_rounds_batch_fn mix_rounds_batch_best = mix_rounds_batch_generic<Full>;
+
+template <bool Full>
+static void select_mix_rounds_batch(crypto::simd_level level) noexcept
+{
+    mix_rounds_batch_best<Full> = mix_rounds_batch_generic<Full>;
+#if HAVE_X86_TARGET_DISPATCH
+    if (level >= crypto::simd_level::avx512)
+        mix_rounds_batch_best<Full> = mix_rounds_batch_avx512<Full>;
+    else if (level >= crypto::simd_level::avx2)
+        mix_rounds_batch_best<Full> = mix_rounds_batch_avx2<Full>;
+    else if (level >= crypto::simd_level::sse4)
+        mix_rounds_batch_best<Full> = mix_rounds_batch_sse4<Full>;
+#else
+    (void)level;
+#endif
+}
+
+static void select_kernels(crypto::simd_level level) noexcept
+{
+    select_mix_rounds<false>(level);
+    select_mix_rounds<true>(level);
+    select_mix_rounds_batch<false>(level);
+    select_mix_rounds_batch<true>(level);
+}
 
 static mix_t init_mix(uint64_t seed)
 {
@@ -449,14 +979,12 @@ ethash::hash256 hash_seed(const ethash::hash256& header_hash, uint64_t nonce) no
 
 ethash::hash256 hash_mix(const ethash::epoch_context& context, const uint32_t period, uint64_t seed)
 {
-    auto mix{init_mix(seed)};
-    mix_rng_state state(period);
-
-    for (uint32_t i{0}; i < kDag_count; ++i)
-    {
-        round(context, i, mix, state);
-    }
+    return hash_mix(context, *get_program(period), seed);
+}
 
+/// Reduces the mix data to the 256-bit mix hash.
+static ethash::hash256 reduce_mix(const mix_t& mix)
+{
     // Reduce mix data to a single per-lane result.
     uint32_t lane_hash[kLanes];
     for (size_t l{0}; l < kLanes; ++l)
@@ -491,6 +1019,36 @@ ethash::hash256 hash_mix(const ethash::epoch_context& context, const uint32_t pe
     return mix_hash;
 }
 
+ethash::hash256 hash_mix(const ethash::epoch_context& context, const program& prog, uint64_t seed)
+{
+    auto mix{init_mix(seed)};
+    if (prog.native_loop)
+    {
+        if (context.full_dataset)
+            mix_rounds_native<true>(context, prog, mix);
+        else
+            mix_rounds_native<false>(context, prog, mix);
+    }
+    else if (context.full_dataset)
+        mix_rounds_best<true>(context, prog, mix);
+    else
+        mix_rounds_best<false>(context, prog, mix);
+    return reduce_mix(mix);
+}
+
+ethash::hash256 hash_mix_reference(const ethash::epoch_context& context, const program& prog, uint64_t seed)
+{
+    auto mix{init_mix(seed)};
+    for (uint32_t i{0}; i < kDag_count; ++i)
+    {
+        if (context.full_dataset)
+            round<true>(context, i, mix, prog);
+        else
+            round<false>(context, i, mix, prog);
+    }
+    return reduce_mix(mix);
+}
+
 ethash::hash256 hash_final(const ethash::hash256& input_hash, const ethash::hash256& mix_hash) noexcept
 {
     uint32_t state[25] = {0};
@@ -506,14 +1064,67 @@ ethash::hash256 hash_final(const ethash::hash256& input_hash, const ethash::hash
 
 ethash::result hash(
     const ethash::epoch_context& context, const uint32_t period, const ethash::hash256& header_hash, uint64_t nonce)
+{
+    return progpow::hash(context, *get_program(period), header_hash, nonce);
+}
+
+ethash::result hash(
+    const ethash::epoch_context& context, const program& prog, const ethash::hash256& header_hash, uint64_t nonce)
 {
     const ethash::hash256 seed_hash{progpow::hash_seed(header_hash, nonce)};
     const uint64_t seed_64{seed_hash.word64s[0]};
-    const ethash::hash256 mix_hash{progpow::hash_mix(context, period, seed_64)};
+    const ethash::hash256 mix_hash{progpow::hash_mix(context, prog, seed_64)};
     const ethash::hash256 final_hash{progpow::hash_final(seed_hash, mix_hash)};
     return {final_hash, mix_hash};
 }
 
+unsigned default_nonces_in_flight() noexcept
+{
+    // The wider the vectors the sooner a round's program is done, thus the more
+    // nonces it takes to cover the DRAM latency of the DAG loads
+    switch (crypto::active_simd_level())
+    {
+    case crypto::simd_level::avx512:
+        return 16;
+    case crypto::simd_level::avx2:
+        return 8;
+    default:
+        return 4;
+    }
+}
+
+void hash_batch(const ethash::epoch_context& context, const program& prog, const ethash::hash256& header_hash,
+    uint64_t start_nonce, size_t count, ethash::result out[], unsigned nonces_in_flight)
+{
+    const size_t group{std::min<size_t>(
+        nonces_in_flight ? nonces_in_flight : default_nonces_in_flight(), kMax_nonces_in_flight)};
+    ethash::hash256 seeds[kMax_nonces_in_flight];
+    soa_mix_t mixes[kMax_nonces_in_flight];
+
+    for (size_t first{0}; first < count; first += group)
+    {
+        const size_t n{std::min(count - first, group)};
+        for (size_t k{0}; k < n; ++k)
+        {
+            seeds[k] = progpow::hash_seed(header_hash, start_nonce + first + k);
+            to_lanes(init_mix(seeds[k].word64s[0]), mixes[k]);
+        }
+
+        if (context.full_dataset)
+            mix_rounds_batch_best<true>(context, prog, mixes, n);
+        else
+            mix_rounds_batch_best<false>(context, prog, mixes, n);
+
+        for (size_t k{0}; k < n; ++k)
+        {
+            mix_t mix;
+            from_lanes(mixes[k], mix);
+            const ethash::hash256 mix_hash{reduce_mix(mix)};
+            out[first + k] = {progpow::hash_final(seeds[k], mix_hash), mix_hash};
+        }
+    }
+}
+
 ethash::VerificationResult verify_full(const ethash::epoch_context& context, const uint32_t period,
     const ethash::hash256& header_hash, const ethash::hash256& mix_hash, uint64_t nonce,
     const ethash::hash256& boundary) noexcept
@@ -535,9 +1146,90 @@ ethash::VerificationResult verify_full(const uint64_t block_number, const ethash
 {
     auto dag_epoch_number{ethash::calculate_epoch_from_block_num(block_number)};
     auto dag_epoch_context{ethash::get_epoch_context(dag_epoch_number, false)};
+    if (!dag_epoch_context)
+        return ethash::VerificationResult::kInvalidMixHash;  // Can't tell, don't vouch for it
     auto progpow_period{block_number / progpow::kPeriodLength};
     return progpow::verify_full(*dag_epoch_context, progpow_period, header_hash, mix_hash, nonce, boundary);
 }
 
 
-}  // namespace progpow
\ No newline at end of file
+std::vector<ethash::VerificationResult> verify_batch(const ethash::epoch_context& context, const uint32_t period,
+    const share shares[], size_t count, unsigned num_threads)
+{
+    // Groups of survivors smaller than this are not worth a thread
+    static constexpr size_t min_shares_per_thread{4 * kMax_nonces_in_flight};
+
+    std::vector<ethash::VerificationResult> results(count, ethash::VerificationResult::kOk);
+    std::vector<ethash::hash256> seeds(count);
+    std::vector<size_t> survivors;
+    survivors.reserve(count);
+
+    // Cheap pass: final hash from the claimed mix
+    for (size_t i{0}; i < count; ++i)
+    {
+        seeds[i] = progpow::hash_seed(shares[i].header_hash, shares[i].nonce);
+        if (ethash::is_less_or_equal(progpow::hash_final(seeds[i], shares[i].mix_hash), shares[i].boundary))
+            survivors.push_back(i);
+        else
+            results[i] = ethash::VerificationResult::kInvalidNonce;
+    }
+    if (survivors.empty())
+        return results;
+
+    const auto prog{get_program(period)};
+    const size_t group{std::min<size_t>(default_nonces_in_flight(), kMax_nonces_in_flight)};
+    std::atomic<size_t> next{0};
+
+    // Workers grab groups of survivors and run their rounds interleaved
+    auto worker = [&]() {
+        soa_mix_t mixes[kMax_nonces_in_flight];
+        for (;;)
+        {
+            const size_t first{next.fetch_add(group, std::memory_order_relaxed)};
+            if (first >= survivors.size())
+                break;
+            const size_t n{std::min(survivors.size() - first, group)};
+            for (size_t k{0}; k < n; ++k)
+                to_lanes(init_mix(seeds[survivors[first + k]].word64s[0]), mixes[k]);
+
+            if (context.full_dataset)
+                mix_rounds_batch_best<true>(context, *prog, mixes, n);
+            else
+                mix_rounds_batch_best<false>(context, *prog, mixes, n);
+
+            for (size_t k{0}; k < n; ++k)
+            {
+                const size_t i{survivors[first + k]};
+                mix_t mix;
+                from_lanes(mixes[k], mix);
+                if (!ethash::is_equal(reduce_mix(mix), shares[i].mix_hash))
+                    results[i] = ethash::VerificationResult::kInvalidMixHash;
+            }
+        }
+    };
+
+    unsigned threads{num_threads ? num_threads : std::thread::hardware_concurrency()};
+    threads = static_cast<unsigned>(
+        std::clamp<size_t>(threads, 1, (survivors.size() + min_shares_per_thread - 1) / min_shares_per_thread));
+
+    std::vector<std::thread> helpers;
+    try
+    {
+        for (unsigned i{1}; i < threads; ++i)
+            helpers.emplace_back(worker);
+    }
+    catch (...)
+    {
+        // Out of threads, the others and the caller do the work
+    }
+    worker();
+    for (auto& helper : helpers)
+        helper.join();
+    return results;
+}
+
+}  // namespace progpow
+void crypto::detail::select_progpow_kernels(simd_level level) noexcept
+{
+    progpow::select_kernels(level);
+}
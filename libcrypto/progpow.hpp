@@ -10,8 +10,11 @@
 
 #include "ethash.hpp"
 #include "kiss99.hpp"
+#include <array>
+#include <memory>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 namespace progpow
 {
@@ -25,11 +28,13 @@ constexpr static uint32_t kCache_count{11};         // random cache accesses per
 constexpr static uint32_t kMath_count{18};          // random math instructions per loop
 
 constexpr static uint32_t kWords_per_lane{sizeof(ethash::hash2048) / (sizeof(uint32_t) * kLanes)};
+constexpr static uint32_t kMax_nonces_in_flight{16};  // Nonces interleaved by hash_batch()
 
 enum class kernel_type
 {
     Cuda,
-    OpenCL
+    OpenCL,
+    Cpu
 };
 
 // ProgPoW mix RNG state.
@@ -54,15 +59,102 @@ private:
     std::array<uint32_t, kRegs> src_seq_;
 };
 
+// ProgPoW random program of a period.
+//
+// All the register indexes and selectors drawn from the mix_rng_state of a period,
+// in execution order. Every round of a period runs the same program, so hashing with
+// a compiled program involves no RNG work at all.
+struct program
+{
+    struct cache_op
+    {
+        uint32_t src;
+        uint32_t dst;
+        uint32_t sel;  // Merge selector
+    };
+
+    struct math_op
+    {
+        uint32_t src1;
+        uint32_t src2;
+        uint32_t dst;
+        uint32_t sel1;  // Math selector
+        uint32_t sel2;  // Merge selector
+    };
+
+    // Native code of one round of the program (see progpow_jit.hpp), working on the
+    // register major mix with the DAG item of the round already loaded
+    using native_loop_fn = void (*)(
+        uint32_t loop, uint32_t mix[][kLanes], const uint32_t dag_item[], const uint32_t l1_cache[]);
+
+    explicit program(uint64_t period) noexcept;
+
+    uint64_t period;
+    std::array<cache_op, kCache_count> cache_ops;
+    std::array<math_op, kMath_count> math_ops;
+    std::array<uint32_t, kWords_per_lane> dag_dsts;  // Merge destinations of the DAG item words
+    std::array<uint32_t, kWords_per_lane> dag_sels;  // Merge selectors of the DAG item words
+
+    native_loop_fn native_loop{nullptr};  // Null if not compiled to native code
+    std::shared_ptr<void> native_module;  // Keeps native_loop loaded
+};
+
+/**
+ * Returns the compiled program of a period. The programs of the last few periods
+ * are kept so the miner and solution verification share them.
+ */
+std::shared_ptr<const program> get_program(uint64_t period);
+
+namespace detail
+{
+/**
+ * Checks the native loop of a period's program against the interpreted one on random
+ * data, then makes get_program() return programs running it.
+ * @return  false if the native loop doesn't compute the same mix
+ */
+bool install_native_loop(uint64_t period, program::native_loop_fn loop, std::shared_ptr<void> module);
+}  // namespace detail
 
 std::string getKern(uint64_t seed, kernel_type kern);
 
 ethash::hash256 hash_seed(const ethash::hash256& header_hash, uint64_t nonce) noexcept;
 ethash::hash256 hash_mix(const ethash::epoch_context& context, const uint32_t period, uint64_t seed);
+ethash::hash256 hash_mix(const ethash::epoch_context& context, const program& prog, uint64_t seed);
+
+/**
+ * Same as hash_mix() computed lane by lane without vectorization. Slow, it's the
+ * oracle the vectorized lane engine is checked against.
+ */
+ethash::hash256 hash_mix_reference(const ethash::epoch_context& context, const program& prog, uint64_t seed);
+
 ethash::hash256 hash_final(const ethash::hash256& input_hash, const ethash::hash256& mix_hash) noexcept;
 
 ethash::result hash(
     const ethash::epoch_context& context, const uint32_t period, const ethash::hash256& header_hash, uint64_t nonce);
+ethash::result hash(
+    const ethash::epoch_context& context, const program& prog, const ethash::hash256& header_hash, uint64_t nonce);
+
+/**
+ * Returns the number of nonces hash_batch() interleaves by default, tuned for the
+ * active instruction set tier (see dispatch.hpp)
+ */
+unsigned default_nonces_in_flight() noexcept;
+
+/**
+ * Hashes count consecutive nonces with their DAG rounds interleaved. While the
+ * program of a round of one nonce runs the DAG loads of the others are in flight,
+ * which hides most of the DRAM latency of a full dataset.
+ * @param context           The DAG epoch context.
+ * @param prog              The program of the period
+ * @param header_hash       The header hash of the block to be hashed
+ * @param start_nonce       The first nonce
+ * @param count             The number of nonces
+ * @param out               Receives count results, out[i] being for start_nonce + i
+ * @param nonces_in_flight  Nonces interleaved, at most kMax_nonces_in_flight.
+ *                          0 means default_nonces_in_flight()
+ */
+void hash_batch(const ethash::epoch_context& context, const program& prog, const ethash::hash256& header_hash,
+    uint64_t start_nonce, size_t count, ethash::result out[], unsigned nonces_in_flight = 0);
 
 ethash::VerificationResult verify_full(const ethash::epoch_context& context, const uint32_t period,
     const ethash::hash256& header_hash, const ethash::hash256& mix_hash, uint64_t nonce,
@@ -71,6 +163,36 @@ ethash::VerificationResult verify_full(const ethash::epoch_context& context, con
 ethash::VerificationResult verify_full(const uint64_t block_number, const ethash::hash256& header_hash,
     const ethash::hash256& mix_hash, uint64_t nonce, const ethash::hash256& boundary) noexcept;
 
+/**
+ * A solution to verify, as submitted by a miner
+ */
+struct share
+{
+    ethash::hash256 header_hash;
+    ethash::hash256 mix_hash;
+    uint64_t nonce;
+    ethash::hash256 boundary;
+};
+
+/**
+ * Verifies many solutions of the same period at once.
+ *
+ * The final hash of each share is checked against its boundary with the mix hash it
+ * claims, which only costs two keccak rounds. Only those passing get their mix hash
+ * recomputed, with the DAG rounds of several shares interleaved (see hash_batch())
+ * and, for large batches, spread over worker threads.
+ *
+ * @param context       The DAG epoch context of the period
+ * @param period        The ProgPoW period
+ * @param shares        The solutions
+ * @param count         The number of solutions
+ * @param num_threads   Threads recomputing mixes, the caller being one of them.
+ *                      0 means all hardware threads. Small batches use the caller only
+ * @return              The outcome of each solution, in order
+ */
+std::vector<ethash::VerificationResult> verify_batch(const ethash::epoch_context& context, const uint32_t period,
+    const share shares[], size_t count, unsigned num_threads = 0);
+
 }  // namespace progpow
 
 #endif  // !CRYPTO_PROGPOW_HPP_
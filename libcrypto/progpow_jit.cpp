@@ -0,0 +1,162 @@
+// firominer: native compilation of ProgPoW programs for the host CPU.
+// Licensed under the Apache License, Version 2.0.
+
+// Written by Firominer's authors 2021
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define HAVE_PROGPOW_JIT 1
+#else
+#define HAVE_PROGPOW_JIT 0
+#endif
+
+#include "progpow.hpp"
+#include "progpow_jit.hpp"
+
+namespace progpow
+{
+namespace
+{
+std::mutex jit_mutex;  // Guards the compiler and serializes compilations
+std::string jit_compiler;
+
+#if HAVE_PROGPOW_JIT
+std::string jit_tmp_dir()
+{
+    const char* tmp{std::getenv("TMPDIR")};
+    std::string dir{tmp && *tmp ? tmp : "/tmp"};
+    while (dir.size() > 1 && dir.back() == '/')
+        dir.pop_back();
+    return dir;
+}
+
+/// Private directory (0700) holding the files of a compilation, removed with them
+class jit_work_dir
+{
+public:
+    jit_work_dir()
+    {
+        std::string templ{jit_tmp_dir() + "/firominer-progpow-XXXXXX"};
+        if (::mkdtemp(&templ[0]))
+            m_path = templ;
+    }
+    ~jit_work_dir()
+    {
+        if (m_path.empty())
+            return;
+        for (const char* name : {"/kernel.cpp", "/kernel.so"})
+            ::unlink((m_path + name).c_str());
+        ::rmdir(m_path.c_str());
+    }
+
+    jit_work_dir(const jit_work_dir&) = delete;
+    jit_work_dir& operator=(const jit_work_dir&) = delete;
+
+    bool valid() const noexcept { return !m_path.empty(); }
+    std::string file(const char* name) const { return m_path + "/" + name; }
+
+private:
+    std::string m_path;
+};
+
+/// Writes a new file, failing if anything already exists at path
+bool write_new_file(const std::string& path, const std::string& content)
+{
+    const int fd{::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600)};
+    if (fd < 0)
+        return false;
+    size_t done{0};
+    while (done < content.size())
+    {
+        const ssize_t n{::write(fd, content.data() + done, content.size() - done)};
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        done += static_cast<size_t>(n);
+    }
+    return ::close(fd) == 0 && done == content.size();
+}
+
+/// Quotes a path for the shell
+std::string quoted(const std::string& path)
+{
+    std::string ret{"'"};
+    for (const char c : path)
+    {
+        if (c == '\'')
+            ret += "'\\''";
+        else
+            ret += c;
+    }
+    return ret + "'";
+}
+#endif
+
+}  // namespace
+
+void set_jit_compiler(const std::string& command)
+{
+    std::lock_guard<std::mutex> lock{jit_mutex};
+    jit_compiler = command;
+}
+
+std::string get_jit_compiler()
+{
+    std::lock_guard<std::mutex> lock{jit_mutex};
+    return jit_compiler;
+}
+
+bool compile_native_program(uint64_t period) noexcept
+{
+#if HAVE_PROGPOW_JIT
+    try
+    {
+        std::lock_guard<std::mutex> lock{jit_mutex};
+        if (jit_compiler.empty())
+            return false;
+        if (get_program(period)->native_loop)
+            return true;
+
+        // Nobody else can create or swap files in a fresh 0700 directory, so the
+        // module loaded is the one the compiler wrote
+        const jit_work_dir dir;
+        if (!dir.valid())
+            return false;
+        const std::string source_path{dir.file("kernel.cpp")};
+        const std::string module_path{dir.file("kernel.so")};
+        if (!write_new_file(source_path, getKern(period, kernel_type::Cpu)))
+            return false;
+
+        const std::string command{jit_compiler + " -shared -fPIC -o " + quoted(module_path) + " " +
+                                  quoted(source_path) + " > /dev/null 2>&1"};
+        if (std::system(command.c_str()) != 0)
+            return false;
+
+        // Once loaded the module stays mapped, the directory goes with dir
+        void* const handle{::dlopen(module_path.c_str(), RTLD_NOW | RTLD_LOCAL)};
+        if (!handle)
+            return false;
+
+        std::shared_ptr<void> module{handle, [](void* h) { ::dlclose(h); }};
+        const auto loop{reinterpret_cast<program::native_loop_fn>(::dlsym(handle, "progPowLoop"))};
+        return loop && detail::install_native_loop(period, loop, std::move(module));
+    }
+    catch (...)
+    {
+        return false;
+    }
+#else
+    (void)period;
+    return false;
+#endif
+}
+
+}  // namespace progpow
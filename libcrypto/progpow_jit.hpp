@@ -0,0 +1,37 @@
+// firominer: native compilation of ProgPoW programs for the host CPU.
+// Licensed under the Apache License, Version 2.0.
+
+// Written by Firominer's authors 2021
+
+#pragma once
+#ifndef CRYPTO_PROGPOW_JIT_HPP_
+#define CRYPTO_PROGPOW_JIT_HPP_
+
+#include <stdint.h>
+#include <string>
+
+namespace progpow
+{
+/**
+ * Sets the compiler command used for native programs, eg "c++ -O3 -march=native".
+ * Flags building a shared object and the file names are appended to it.
+ * Empty (the default) disables native programs.
+ */
+void set_jit_compiler(const std::string& command);
+
+std::string get_jit_compiler();
+
+/**
+ * Generates the C++ kernel of a period's program (see getKern()), compiles it with
+ * the JIT compiler, loads it and, once checked, makes get_program() return the
+ * program running it. Blocks for as long as the compiler runs, thus meant to be
+ * called ahead of the period from a low priority thread.
+ *
+ * @param period    The ProgPoW period
+ * @return          Whether the program of the period runs native code
+ */
+bool compile_native_program(uint64_t period) noexcept;
+
+}  // namespace progpow
+
+#endif  // !CRYPTO_PROGPOW_JIT_HPP_
@@ -0,0 +1,133 @@
+/*
+    This file is part of firominer.
+
+    firominer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    firominer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with firominer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file WakeEvent.cpp
+ * @date 2021
+ */
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "WakeEvent.h"
+
+using namespace std;
+using namespace dev;
+
+void WakeEvent::signal() noexcept
+{
+    if (m_state.exchange(Set, memory_order_release) == Sleeping)
+        wakeUp();
+}
+
+void WakeEvent::wait() noexcept
+{
+    waitUntil(nullptr);
+}
+
+bool WakeEvent::waitFor(chrono::milliseconds _timeout) noexcept
+{
+    const auto deadline = chrono::steady_clock::now() + _timeout;
+    return waitUntil(&deadline);
+}
+
+bool WakeEvent::reset() noexcept
+{
+    uint32_t state = Set;
+    return m_state.compare_exchange_strong(state, Clear, memory_order_acquire);
+}
+
+bool WakeEvent::waitUntil(chrono::steady_clock::time_point const* _deadline) noexcept
+{
+    for (;;)
+    {
+        uint32_t state = m_state.load(memory_order_acquire);
+        if (state == Set)
+        {
+            if (m_state.compare_exchange_weak(state, Clear, memory_order_acquire))
+                return true;
+            continue;
+        }
+
+        // Tell signalers they have to wake us
+        if (state == Clear && !m_state.compare_exchange_weak(state, Sleeping, memory_order_relaxed))
+            continue;
+
+        if (_deadline && chrono::steady_clock::now() >= *_deadline)
+        {
+            uint32_t sleeping = Sleeping;
+            if (m_state.compare_exchange_strong(sleeping, Clear, memory_order_relaxed))
+                return false;
+            continue;  // Signaled meanwhile
+        }
+
+        sleep(_deadline);
+    }
+}
+
+#if defined(__linux__)
+
+void WakeEvent::sleep(chrono::steady_clock::time_point const* _deadline) noexcept
+{
+    timespec timeout;
+    timespec* ptimeout = nullptr;
+    if (_deadline)
+    {
+        const auto ns = chrono::duration_cast<chrono::nanoseconds>(*_deadline - chrono::steady_clock::now()).count();
+        if (ns <= 0)
+            return;
+        timeout.tv_sec = (time_t)(ns / 1000000000);
+        timeout.tv_nsec = (long)(ns % 1000000000);
+        ptimeout = &timeout;
+    }
+
+    // Returns at once if the state is no longer Sleeping. Interruptions and
+    // spurious returns are sorted out by the caller
+    static_assert(sizeof(m_state) == sizeof(uint32_t), "futex needs a plain 32 bit word");
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_state), FUTEX_WAIT_PRIVATE, (uint32_t)Sleeping, ptimeout,
+        nullptr, 0);
+}
+
+void WakeEvent::wakeUp() noexcept
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_state), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+#else
+
+void WakeEvent::sleep(chrono::steady_clock::time_point const* _deadline) noexcept
+{
+    unique_lock<mutex> l(x_sleep);
+    auto signaled = [this]() { return m_state.load(memory_order_relaxed) != Sleeping; };
+    if (_deadline)
+        m_sleep.wait_until(l, *_deadline, signaled);
+    else
+        m_sleep.wait(l, signaled);
+}
+
+void WakeEvent::wakeUp() noexcept
+{
+    // Taking the lock orders the state change before the waiter's check
+    {
+        lock_guard<mutex> l(x_sleep);
+    }
+    m_sleep.notify_one();
+}
+
+#endif
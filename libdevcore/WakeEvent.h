@@ -0,0 +1,86 @@
+/*
+    This file is part of firominer.
+
+    firominer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    firominer is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with firominer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file WakeEvent.h
+ * @date 2021
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if !defined(__linux__)
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace dev
+{
+/**
+ * @brief Auto-reset event one thread sleeps on until others signal it
+ *
+ * A signal sets the event and wakes the waiting thread, which resets it on return.
+ * Signals are not lost: if nobody waits the next wait returns at once. They are not
+ * counted either, several signals before a wait wake it once. Signaling costs an
+ * atomic exchange, plus a system call only when the waiter sleeps.
+ *
+ * On Linux the waiter sleeps on a futex, elsewhere on a condition variable.
+ *
+ * @note One waiting thread at a time, any number of signaling ones.
+ */
+class WakeEvent
+{
+public:
+    WakeEvent() = default;
+
+    WakeEvent(WakeEvent const&) = delete;
+    WakeEvent& operator=(WakeEvent const&) = delete;
+
+    /// Sets the event, waking the waiting thread if any
+    void signal() noexcept;
+
+    /// Waits for the event to be set, then resets it
+    void wait() noexcept;
+
+    /// Same as wait() giving up after _timeout. Returns whether the event was set
+    bool waitFor(std::chrono::milliseconds _timeout) noexcept;
+
+    /// Resets the event without waiting. Returns whether it was set
+    bool reset() noexcept;
+
+private:
+    enum : uint32_t
+    {
+        Clear = 0,
+        Set = 1,
+        Sleeping = 2  // Clear and the waiter sleeps, signal() must wake it
+    };
+
+    bool waitUntil(std::chrono::steady_clock::time_point const* _deadline) noexcept;
+    void sleep(std::chrono::steady_clock::time_point const* _deadline) noexcept;
+    void wakeUp() noexcept;
+
+    std::atomic<uint32_t> m_state = {Clear};
+
+#if !defined(__linux__)
+    std::mutex x_sleep;
+    std::condition_variable m_sleep;
+#endif
+};
+
+}  // namespace dev
@@ -19,15 +19,45 @@
  * @date 2014
  */
 
-#include <chrono>
+#include <algorithm>
 #include <thread>
 
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#elif defined(WIN32)
+#include <windows.h>
+#endif
+
 #include "Log.h"
 #include "Worker.h"
 
 using namespace std;
 using namespace dev;
 
+bool dev::lowerThreadPriority(ThreadPriority _priority)
+{
+#if defined(__linux__)
+    // Under POSIX the nice value is a process attribute, under Linux it's a
+    // thread attribute
+    const id_t tid = (id_t)syscall(SYS_gettid);
+    errno = 0;
+    const int current = getpriority(PRIO_PROCESS, tid);
+    if (current == -1 && errno)
+        return false;
+    const int target = _priority == ThreadPriority::Idle ? 19 : min(19, current + 5);
+    return setpriority(PRIO_PROCESS, tid, max(current, target)) == 0;
+#elif defined(WIN32)
+    return SetThreadPriority(GetCurrentThread(),
+        _priority == ThreadPriority::Idle ? THREAD_PRIORITY_IDLE : THREAD_PRIORITY_BELOW_NORMAL);
+#else
+    (void)_priority;
+    return false;
+#endif
+}
+
 void Worker::startWorking()
 {
     //	cnote << "startWorking for thread" << m_name;
@@ -36,6 +66,7 @@ void Worker::startWorking()
     {
         WorkerState ex = WorkerState::Stopped;
         m_state.compare_exchange_weak(ex, WorkerState::Starting, std::memory_order_relaxed);
+        m_wakeUp.signal();
     }
     else
     {
@@ -46,11 +77,12 @@ void Worker::startWorking()
             while (m_state != WorkerState::Killing)
             {
                 WorkerState ex = WorkerState::Starting;
-                bool ok = m_state.compare_exchange_weak(
+                bool ok = m_state.compare_exchange_strong(
                     ex, WorkerState::Started, std::memory_order_relaxed);
                 //				cnote << "Trying to set Started: Thread was" << (unsigned)ex << "; "
                 //<< ok;
                 (void)ok;
+                m_stateChanged.signal();
 
                 try
                 {
@@ -74,15 +106,16 @@ void Worker::startWorking()
                 //				cnote << "State: Stopped: Thread was" << (unsigned)ex;
                 if (ex == WorkerState::Killing || ex == WorkerState::Starting)
                     m_state.exchange(ex);
+                m_stateChanged.signal();
 
                 while (m_state == WorkerState::Stopped)
-                    this_thread::sleep_for(chrono::milliseconds(20));
+                    m_wakeUp.wait();
             }
         }));
         //		cnote << "Spawning" << m_name;
     }
     while (m_state == WorkerState::Starting)
-        this_thread::sleep_for(chrono::microseconds(20));
+        m_stateChanged.wait();
 }
 
 void Worker::triggerStopWorking()
@@ -92,6 +125,7 @@ void Worker::triggerStopWorking()
     {
         WorkerState ex = WorkerState::Started;
         m_state.compare_exchange_weak(ex, WorkerState::Stopping, std::memory_order_relaxed);
+        m_wakeUp.signal();
     }
 }
 
@@ -102,9 +136,10 @@ void Worker::stopWorking()
     {
         WorkerState ex = WorkerState::Started;
         m_state.compare_exchange_weak(ex, WorkerState::Stopping, std::memory_order_relaxed);
+        m_wakeUp.signal();
 
         while (m_state != WorkerState::Stopped)
-            this_thread::sleep_for(chrono::microseconds(20));
+            m_stateChanged.wait();
     }
 }
 
@@ -114,6 +149,7 @@ Worker::~Worker()
     if (m_work)
     {
         m_state.exchange(WorkerState::Killing);
+        m_wakeUp.signal();
         m_work->join();
         m_work.reset();
     }
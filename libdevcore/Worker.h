@@ -28,11 +28,22 @@
 #include <thread>
 
 #include "Guards.h"
+#include "WakeEvent.h"
 
 extern bool g_exitOnError;
 
 namespace dev
 {
+enum class ThreadPriority
+{
+    BelowNormal,  ///< Background work the user may wait for (kernel compiles)
+    Idle          ///< Work only worth the spare cycles (DAG prebuilds)
+};
+
+/// Lowers the scheduling priority of the calling thread. On Linux it is inherited
+/// by the threads it spawns. Returns false if unsupported or refused
+bool lowerThreadPriority(ThreadPriority _priority);
+
 enum class WorkerState
 {
     Starting,
@@ -66,6 +77,14 @@ public:
 
     std::string name() { return m_name; }
 
+protected:
+    /// Wakes the worker thread out of waitForWakeUp()
+    void wakeUp() { m_wakeUp.signal(); }
+
+    /// Sleeps until wakeUp() is called or the worker is told to stop. Returns at once
+    /// if that happened since the previous call
+    void waitForWakeUp() { m_wakeUp.wait(); }
+
 private:
     virtual void workLoop() = 0;
 
@@ -74,6 +93,8 @@ private:
     mutable Mutex x_work;                 ///< Lock for the network existence.
     std::unique_ptr<std::thread> m_work;  ///< The network thread.
     std::atomic<WorkerState> m_state = {WorkerState::Starting};
+    WakeEvent m_wakeUp;        ///< Wakes the worker thread
+    WakeEvent m_stateChanged;  ///< Wakes the thread waiting for the worker thread to start or stop
 };
 
 }  // namespace dev
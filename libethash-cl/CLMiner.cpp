@@ -289,11 +289,13 @@ void CLMiner::workLoop()
     // Memory for zero-ing buffers. Cannot be static or const because crashes on macOS.
     static uint32_t zerox3[3] = {0, 0, 0};
 
-    uint64_t startNonce = 0;
-
     // The work package currently processed by GPU.
-    WorkPackage current;
-    current.header = h256();
+    std::shared_ptr<const WorkPackage> current = std::make_shared<const WorkPackage>();
+    NonceRange currentRange;
+
+    // The latest work package, only fetched again when its generation changes
+    std::shared_ptr<const WorkPackage> next;
+    uint64_t generation = 0;
     uint64_t old_period_seed = -1;
     int old_epoch = -1;
 
@@ -325,20 +327,18 @@ void CLMiner::workLoop()
                 m_searchBuffer, CL_FALSE, offsetof(SearchResults, count), sizeof(zerox3), zerox3);
             m_kickEnabled.store(true, std::memory_order_relaxed);
 
-            // Wait for work or 3 seconds (whichever the first)
-            bool new_work_expected{true};
-
-            const WorkPackage next = work();
-            if (!next)
+            // Pick up the latest work, sleep until some arrives
+            if (!next || workGeneration() != generation)
+                next = work(generation);
+            if (!*next)
             {
-                std::unique_lock l(x_work);
-                m_new_work_signal.wait_for(l, std::chrono::milliseconds(50));
+                waitForWakeUp();
                 continue;
             }
 
-            if (current.header != next.header)
+            if (current->header != next->header)
             {
-                uint64_t period_seed = next.block.value() / progpow::kPeriodLength;
+                uint64_t period_seed = next->block.value() / progpow::kPeriodLength;
                 if (m_nextProgpowPeriod == 0)
                 {
                     m_nextProgpowPeriod = period_seed;
@@ -400,16 +400,16 @@ void CLMiner::workLoop()
                     }));
                     continue;
                 }
-                if (next.epoch.has_value() && old_epoch != static_cast<int>(next.epoch.value()))
+                if (next->epoch.has_value() && old_epoch != static_cast<int>(next->epoch.value()))
                 {
                     if (!initEpoch())
                         break;  // This will simply exit the thread
-                    old_epoch = static_cast<int>(next.epoch.value());
+                    old_epoch = static_cast<int>(next->epoch.value());
                     continue;
                 }
 
                 // Upper 64 bits of the boundary.
-                const uint64_t target = (uint64_t)(u64)((u256)next.get_boundary() >> 192);
+                const uint64_t target = (uint64_t)(u64)((u256)next->get_boundary() >> 192);
                 assert(target > 0);
 
                 // If upper 64 bits of target are 0xffffffffffffffff then any nonce would
@@ -420,10 +420,8 @@ void CLMiner::workLoop()
                     continue;
                 }
 
-                startNonce = next.startNonce;
-
                 // Update header constant buffer.
-                m_queue.enqueueWriteBuffer(m_header, CL_FALSE, 0, 32, next.header.data());
+                m_queue.enqueueWriteBuffer(m_header, CL_FALSE, 0, 32, next->header.data());
 
                 m_searchKernel.setArg(0, m_searchBuffer);  // Supply output buffer to kernel.
                 m_searchKernel.setArg(1, m_header);        // Supply header buffer to kernel.
@@ -440,32 +438,42 @@ void CLMiner::workLoop()
 #endif
             }
 
-            // Run the kernel.
-            m_searchKernel.setArg(3, startNonce);
-            m_queue.enqueueNDRangeKernel(
-                m_searchKernel, cl::NullRange, m_settings.globalWorkSize, m_settings.localWorkSize);
+            // Run the kernel on nonces claimed from the job.
+            NonceRange range;
+            const bool launched = next->nonces->claim(m_index, m_settings.globalWorkSize, range);
+            if (launched)
+            {
+                m_searchKernel.setArg(3, range.first);
+                m_queue.enqueueNDRangeKernel(
+                    m_searchKernel, cl::NullRange, m_settings.globalWorkSize, m_settings.localWorkSize);
+            }
 
             if (results.count)
             {
                 // Report results while the kernel is running.
                 for (uint32_t i = 0; i < results.count; i++)
                 {
-                    uint64_t nonce = current.startNonce + results.rslt[i].gid;
+                    // A kernel overruns a short range, those nonces were handed to others
+                    if (results.rslt[i].gid >= currentRange.count)
+                        continue;
+                    uint64_t nonce = currentRange.first + results.rslt[i].gid;
                     h256 mix;
                     memcpy(mix.data(), (char*)results.rslt[i].mix, sizeof(results.rslt[i].mix));
 
-                    Farm::f().submitProof(Solution{nonce, mix, current, std::chrono::steady_clock::now(), m_index});
+                    Farm::f().submitProof(Solution{nonce, mix, *current, std::chrono::steady_clock::now(), m_index});
 
-                    cllog << EthWhite << "Job: " << current.header.abridged() << " Sol: 0x" << toHex(nonce) << EthReset;
+                    cllog << EthWhite << "Job: " << current->header.abridged() << " Sol: 0x" << toHex(nonce) << EthReset;
                 }
             }
 
             current = next;  // kernel now processing newest work
-            current.startNonce = startNonce;
-            // Increase start nonce for following kernel execution.
-            startNonce += m_settings.globalWorkSize;
+            currentRange = launched ? range : NonceRange();
             // Report hash count
             updateHashRate(m_settings.localWorkSize, results.hashCount);
+
+            // The nonces of the job ran out, wait for the next one
+            if (!launched)
+                waitForWakeUp();
         }
 
         m_queue.finish();
@@ -487,7 +495,7 @@ void CLMiner::kick_miner()
         static const uint32_t one = 1;
         m_abortqueue.enqueueWriteBuffer(m_searchBuffer, CL_TRUE, offsetof(SearchResults, abort), sizeof(one), &one);
     }
-    m_new_work_signal.notify_one();
+    wakeUp();
 }
 
 void CLMiner::enumDevices(std::map<std::string, DeviceDescriptor>& _DevicesCollection)
@@ -15,11 +15,6 @@ You should have received a copy of the GNU General Public License
 along with firominer.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-/*
- CPUMiner simulates mining devices but does NOT real mine!
- USE FOR DEVELOPMENT ONLY !
-*/
-
 #if defined(__linux__)
 #if !defined(_GNU_SOURCE)
 #define _GNU_SOURCE /* we need sched_setaffinity() */
@@ -31,8 +26,12 @@ along with firominer.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <libethcore/Farm.h>
 #include <libcrypto/progpow.hpp>
+#include <libcrypto/progpow_jit.hpp>
 
-#include <boost/version.hpp>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
 
 #if 0
 #include <boost/fiber/numa/pin_thread.hpp>
@@ -40,6 +39,7 @@ along with firominer.  If not, see <http://www.gnu.org/licenses/>.
 #endif
 
 #include "CPUMiner.h"
+#include "CPUTopology.h"
 
 
 /* Sanity check for defined OS */
@@ -96,6 +96,28 @@ static size_t getTotalPhysAvailableMemory()
 #endif
 }
 
+/*
+ * returns the model name of the CPUs
+ */
+static std::string getCpuModelName()
+{
+#if defined(__linux__)
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line))
+    {
+        if (line.compare(0, 10, "model name") != 0)
+            continue;
+        auto pos = line.find(':');
+        if (pos == std::string::npos)
+            break;
+        pos = line.find_first_not_of(" \t", pos + 1);
+        return pos == std::string::npos ? std::string() : line.substr(pos);
+    }
+#endif
+    return "CPU";
+}
+
 /*
  * return numbers of available CPUs
  */
@@ -165,9 +187,15 @@ bool CPUMiner::initDevice()
 {
     DEV_BUILD_LOG_PROGRAMFLOW(cpulog, "cp-" << m_index << " CPUMiner::initDevice begin");
 
-    cpulog << "Using CPU: " << m_deviceDescriptor.cpCpuNumer << " " << m_deviceDescriptor.cuName
+    cpulog << "Using CPU: " << m_deviceDescriptor.cpCpuNumer << " core " << m_deviceDescriptor.cpCore << " L3 "
+           << m_deviceDescriptor.cpL3 << " " << m_deviceDescriptor.name
            << " Memory : " << dev::getFormattedMemory((double)m_deviceDescriptor.totalMemory);
 
+    // DAG reads go to the replica local to the node of the CPU we're bound to
+    m_numaNode = m_deviceDescriptor.cpNumaNode;
+    if (m_numaNode >= 0)
+        cpulog << "cp-" << m_index << " on NUMA node " << m_numaNode;
+
 #if defined(__APPLE__) || defined(__MACOSX)
 #error "TODO: Function CPUMiner::initDevice() on MAXOSX not implemented"
 #elif defined(__linux__)
@@ -201,13 +229,32 @@ bool CPUMiner::initDevice()
 /*
  * A new epoch was receifed with last work package (called from Miner::initEpoch())
  *
- * If we get here it means epoch has changed so it's not necessary
- * to check again dag sizes. They're changed for sure
- * We've all related infos in m_epochContext (.dagSize, .dagNumItems, .lightSize, .lightNumItems)
+ * Acquires the full DAG of the epoch. It's shared by all CPU miners (one copy per
+ * NUMA node) and built only once, by all CPUs, the first miner to ask waiting
+ * for it and the others waiting on that build. It stays pinned while we mine it.
  */
 bool CPUMiner::initEpoch_internal()
 {
-    // std::cout << "initEpoch_internal" << std::endl;
+    const uint32_t epoch{m_epochContext->epoch_number};
+    auto startInit = std::chrono::steady_clock::now();
+
+    m_dagContext.reset();
+    m_dagContext = m_numaNode >= 0 ? ethash::get_numa_epoch_context(epoch, m_numaNode) :
+                                     ethash::get_epoch_context(epoch, true);
+    if (!m_dagContext)
+    {
+        cpulog << "Unable to get the DAG of epoch " << epoch << ", out of memory";
+        return false;
+    }
+
+    if (m_index == 0)
+    {
+        cpulog << "Epoch " << epoch << " DAG " << dev::getFormattedMemory((double)m_dagContext->full_dataset_size)
+               << " on " << ethash::to_string(m_dagContext->pages) << " pages ready in "
+               << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startInit)
+                      .count()
+               << " ms";
+    }
     return true;
 }
 
@@ -221,47 +268,45 @@ bool CPUMiner::initEpoch_internal()
 */
 void CPUMiner::kick_miner()
 {
-    m_new_work.store(true, std::memory_order_relaxed);
-    m_new_work_signal.notify_one();
+    wakeUp();
 }
 
 
-void CPUMiner::search(const dev::eth::WorkPackage& w)
+void CPUMiner::search(const dev::eth::WorkPackage& w, uint64_t generation)
 {
     DEV_BUILD_LOG_PROGRAMFLOW(cpulog, "cp-" << m_index << " CPUMiner::search() begin");
-    constexpr size_t blocksize = 64;
-
-    const auto context{ethash::get_epoch_context(w.epoch.value(), true)};
-    DEV_BUILD_LOG_PROGRAMFLOW(cpulog, "cp-" << m_index << " CPUMiner::search() context loaded");
+    const size_t blocksize{m_settings.blockSize};
+    std::vector<ethash::result> results(blocksize);
 
     auto header{ethash::from_bytes(w.header.data())};
     auto boundary{ethash::from_bytes(w.get_boundary().data())};
-    auto period{w.block.value() / progpow::kPeriodLength};
-    auto nonce{w.startNonce};
-    bool found{false};
+    const auto program{progpow::get_program(w.block.value() / progpow::kPeriodLength)};
+    NonceRange range;
 
+    // Keeps searching after solutions until new work arrives, we're told to stop or
+    // the nonces of the job run out
     DEV_BUILD_LOG_PROGRAMFLOW(cpulog, "cp-" << m_index << " CPUMiner::search() search loop");
-    while (m_new_work.load(std::memory_order_relaxed) == false && !found)
+    while (workGeneration() == generation && !shouldStop() && w.nonces->claim(m_index, blocksize, range))
     {
-        // Do the search
-        for (size_t i{0}; i < blocksize; i++, nonce++)
+        const size_t count{static_cast<size_t>(range.count)};
+        auto nonce{range.first};
+        progpow::hash_batch(
+            *m_dagContext, *program, header, nonce, count, results.data(), m_settings.noncesInFlight);
+        for (size_t i{0}; i < count; i++, nonce++)
         {
-            auto result{progpow::hash(*context, period, header, nonce)};
+            auto& result{results[i]};
             if (ethash::is_less_or_equal(result.final_hash, boundary))
             {
                 h256 mix{reinterpret_cast<::byte*>(result.mix_hash.bytes), h256::ConstructFromPointer};
-                h256 fin{reinterpret_cast<::byte*>(result.final_hash.bytes), h256::ConstructFromPointer};
                 Solution sol{nonce, mix, w, std::chrono::steady_clock::now(), m_index};
                 cpulog << EthWhite << "Job: " << w.header.abridged() << " Sol: " << toHex(sol.nonce, HexPrefix::Add)
                        << EthReset;
                 Farm::f().submitProof(sol);
-                found = true;
-                break;
             }
         }
 
         // Update the hash rate
-        updateHashRate(blocksize, 1);
+        updateHashRate(1, static_cast<uint32_t>(count));
     }
 
     DEV_BUILD_LOG_PROGRAMFLOW(cpulog, "cp-" << m_index << " CPUMiner::search() end");
@@ -275,93 +320,227 @@ void CPUMiner::workLoop()
 {
     DEV_BUILD_LOG_PROGRAMFLOW(cpulog, "cp-" << m_index << " CPUMiner::workLoop() begin");
 
-    WorkPackage current;
-    current.header = h256();
-
     if (!initDevice())
     {
         return;
     }
 
-    while (!shouldStop())
+    // The compiler thread must be joined whichever way the loop ends
+    try
     {
-        // Wait for work
-        bool new_work_expected{true};
-        if (!m_new_work.compare_exchange_strong(new_work_expected, false))
+        uint64_t generation{0};
+        while (!shouldStop())
         {
-            std::unique_lock l(x_work);
-            m_new_work_signal.wait_for(l, std::chrono::milliseconds(50));
-            continue;
+            // Wait for new work, a pause or a stop
+            if (workGeneration() == generation)
+            {
+                waitForWakeUp();
+                continue;
+            }
+
+            const auto wp = work(generation);
+            const WorkPackage& w = *wp;
+            if (!w)
+            {
+                continue;
+            }
+
+            if (w.algo == "progpow")
+            {
+                // Epoch change ?
+                if (!m_dagContext || m_dagContext->epoch_number != w.epoch.value())
+                {
+                    if (!initEpoch())
+                    {
+                        break;  // This will simply exit the thread
+                    }
+
+                    // As DAG generation takes a while we need to
+                    // ensure we're on latest job, not on the one
+                    // which triggered the epoch change
+                    if (workGeneration() != generation)
+                    {
+                        continue;
+                    }
+                }
+
+                // Native programs are shared by all miners, the first one has them compiled
+                // one period ahead
+                const uint64_t period{w.block.value() / progpow::kPeriodLength};
+                if (m_settings.jit && m_index == 0 && m_nextProgpowPeriod != period + 1)
+                {
+                    m_nextProgpowPeriod = period + 1;
+                    requestCompile(period);
+                }
+
+                // Start searching
+                search(w, generation);
+            }
+            else
+            {
+                throw std::runtime_error("Algo : " + w.algo + " not yet implemented");
+            }
         }
+    }
+    catch (...)
+    {
+        stopCompiler();
+        m_dagContext.reset();
+        throw;
+    }
+
+    stopCompiler();
+    m_dagContext.reset();
+
+    DEV_BUILD_LOG_PROGRAMFLOW(cpulog, "cp-" << m_index << " CPUMiner::workLoop() end");
+}
+
+
+/*
+ * Hands a period to the compiler thread, never waiting for it. A period still
+ * pending is superseded: only the latest matters
+ */
+void CPUMiner::requestCompile(uint64_t period)
+{
+    {
+        std::lock_guard<std::mutex> l(x_compile);
+        m_compilePeriod = period;
+        m_compilePending = true;
+    }
+    if (!m_compileThread)
+        m_compileThread.reset(new std::thread([this] { compileLoop(); }));
+    m_compileWake.signal();
+}
+
 
-        const WorkPackage w = work();
-        if (!w)
+/*
+ * Stops and joins the compiler thread, if started
+ */
+void CPUMiner::stopCompiler()
+{
+    if (!m_compileThread)
+        return;
+    {
+        std::lock_guard<std::mutex> l(x_compile);
+        m_compileStop = true;
+    }
+    m_compileWake.signal();
+    m_compileThread->join();
+    m_compileThread.reset();
+    m_compileStop = false;
+    m_nextProgpowPeriod = 0;
+}
+
+
+void CPUMiner::compileLoop()
+{
+    setThreadName(name().c_str());
+    if (!dropThreadPriority())
+        cpulog << "Unable to lower compiler priority.";
+
+    for (;;)
+    {
+        uint64_t period;
         {
-            continue;
+            std::lock_guard<std::mutex> l(x_compile);
+            if (m_compileStop)
+                break;
+            period = m_compilePeriod;
+            if (!m_compilePending)
+                period = ~0ULL;
+            m_compilePending = false;
         }
-
-        if (w.algo == "progpow")
+        if (period == ~0ULL)
         {
-            //// Epoch change ?
-            // if (current.epoch != w.epoch)
-            //{
-            //    if (!initEpoch())
-            //    {
-            //        break;  // This will simply exit the thread
-            //    }
-
-            //    // As DAG generation takes a while we need to
-            //    // ensure we're on latest job, not on the one
-            //    // which triggered the epoch change
-            //    current = w;
-            //    continue;
-            //}
-
-            // Persist most recent job.
-            // Job's differences should be handled at higher level
-            current = w;
-
-            // Start searching
-            search(w);
+            m_compileWake.wait();
+            continue;
         }
-        else
+
+        // The current period only the first time, afterwards it's already compiled
+        for (const uint64_t p : {period, period + 1})
         {
-            throw std::runtime_error("Algo : " + w.algo + " not yet implemented");
+            if (!progpow::compile_native_program(p))
+                cpulog << "Failed to compile ProgPoW kernel for period " << p << ", interpreting it";
         }
     }
-
-    DEV_BUILD_LOG_PROGRAMFLOW(cpulog, "cp-" << m_index << " CPUMiner::workLoop() end");
 }
 
 
 void CPUMiner::enumDevices(std::map<string, DeviceDescriptor>& _DevicesCollection)
 {
-    unsigned numDevices = getNumDevices();
-
-    for (unsigned i = 0; i < numDevices; i++)
+    for (const auto& t : scanCpuTopology())
     {
         string uniqueId;
         ostringstream s;
         DeviceDescriptor deviceDescriptor;
 
-        s << "cpu-" << i;
+        s << "cpu-" << t.cpu;
         uniqueId = s.str();
         if (_DevicesCollection.find(uniqueId) != _DevicesCollection.end())
             deviceDescriptor = _DevicesCollection[uniqueId];
         else
             deviceDescriptor = DeviceDescriptor();
 
-        s.str("");
-        s.clear();
-        s << "ethash::eval()/boost " << (BOOST_VERSION / 100000) << "." << (BOOST_VERSION / 100 % 1000) << "."
-          << (BOOST_VERSION % 100);
-        deviceDescriptor.name = s.str();
+        deviceDescriptor.name = getCpuModelName();
         deviceDescriptor.uniqueId = uniqueId;
         deviceDescriptor.type = DeviceTypeEnum::Cpu;
+        deviceDescriptor.cpDetected = true;
         deviceDescriptor.totalMemory = getTotalPhysAvailableMemory();
 
-        deviceDescriptor.cpCpuNumer = i;
+        deviceDescriptor.cpCpuNumer = t.cpu;
+        deviceDescriptor.cpCore = t.core;
+        deviceDescriptor.cpL3 = t.l3;
+        deviceDescriptor.cpNumaNode = t.numaNode;
 
         _DevicesCollection[uniqueId] = deviceDescriptor;
     }
 }
+
+
+/*
+ * Picks the CPUs of the mining threads, in the order threads are to be placed
+ *
+ *  all    every logical CPU, SMT siblings included
+ *  cores  one thread per physical core, spread round robin over the L3 domains
+ *  l3     one thread per physical core, filling an L3 domain before the next
+ *
+ * The first _settings.reserveCores cores are left free for the GPU feeder, network
+ * and io threads (CPU 0 also often serves most interrupts).
+ */
+std::vector<unsigned> CPUMiner::placeThreads(const CPSettings& _settings)
+{
+    std::vector<CpuTopology> candidates;
+    for (const auto& t : scanCpuTopology())
+    {
+        if (t.core >= _settings.reserveCores && (_settings.placement == "all" || t.primaryThread))
+            candidates.push_back(t);
+    }
+
+    if (_settings.placement == "l3")
+    {
+        std::stable_sort(candidates.begin(), candidates.end(),
+            [](const CpuTopology& a, const CpuTopology& b) { return a.l3 < b.l3; });
+    }
+    else if (_settings.placement == "cores")
+    {
+        // Rank of each core within its domain, then rank major order
+        std::map<unsigned, unsigned> domainCount;
+        std::vector<std::pair<unsigned, CpuTopology>> ranked;
+        for (const auto& t : candidates)
+            ranked.emplace_back(domainCount[t.l3]++, t);
+        std::stable_sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+            return a.first != b.first ? a.first < b.first : a.second.l3 < b.second.l3;
+        });
+        for (size_t i = 0; i < ranked.size(); i++)
+            candidates[i] = ranked[i].second;
+    }
+
+    std::vector<unsigned> cpus;
+    for (const auto& t : candidates)
+    {
+        if (_settings.threads && cpus.size() == _settings.threads)
+            break;
+        cpus.push_back(t.cpu);
+    }
+    return cpus;
+}
@@ -21,6 +21,9 @@ along with firominer.  If not, see <http://www.gnu.org/licenses/>.
 #include <libethcore/Miner.h>
 
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace dev
 {
@@ -34,8 +37,9 @@ public:
 
     static unsigned getNumDevices();
     static void enumDevices(std::map<std::string, DeviceDescriptor>& _DevicesCollection);
+    static std::vector<unsigned> placeThreads(const CPSettings& _settings);
 
-    void search(const dev::eth::WorkPackage& w);
+    void search(const dev::eth::WorkPackage& w, uint64_t generation);
 
 protected:
     bool initDevice() override;
@@ -43,8 +47,17 @@ protected:
     void kick_miner() override;
 
 private:
-    std::atomic<bool> m_new_work = {false};
+    std::shared_ptr<ethash::epoch_context> m_dagContext;  // Full DAG of the current epoch
+    int m_numaNode = -1;                                  // NUMA node of the bound CPU, -1 if not NUMA
     void workLoop() override;
+    void requestCompile(uint64_t period);
+    void stopCompiler();
+    void compileLoop();
+    std::mutex x_compile;
+    uint64_t m_compilePeriod = 0;   // Latest period the compiler thread was asked for
+    bool m_compilePending = false;  // m_compilePeriod not picked up yet
+    bool m_compileStop = false;
+    WakeEvent m_compileWake;        // Wakes the compiler thread
     CPSettings m_settings;
 };
 
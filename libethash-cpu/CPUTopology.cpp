@@ -0,0 +1,166 @@
+/*
+This file is part of firominer.
+
+firominer is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+firominer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with firominer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include "CPUTopology.h"
+
+using namespace std;
+
+namespace dev
+{
+namespace eth
+{
+/*
+ * reads the first line of a sysfs file
+ */
+static bool readSysfsLine(const std::string& path, std::string& line)
+{
+    std::ifstream file(path);
+    return static_cast<bool>(std::getline(file, line));
+}
+
+/*
+ * parses a sysfs list of ids such as "0-3,8-11"
+ */
+std::vector<unsigned> parseSysfsList(const std::string& list)
+{
+    std::vector<unsigned> ids;
+    std::istringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ','))
+    {
+        unsigned first, last;
+        int n = sscanf(range.c_str(), "%u-%u", &first, &last);
+        if (n < 1)
+            continue;
+        if (n == 1)
+            last = first;
+        for (unsigned id = first; id <= last; id++)
+            ids.push_back(id);
+    }
+    return ids;
+}
+
+/*
+ * returns the NUMA node of a CPU or -1 if unknown or if there's only one node
+ */
+int getCpuNumaNode(unsigned cpu)
+{
+#if defined(__linux__)
+    std::string nodes;
+    if (!readSysfsLine("/sys/devices/system/node/online", nodes))
+        return -1;
+
+    std::vector<unsigned> ids = parseSysfsList(nodes);
+    if (ids.size() < 2)
+        return -1;
+
+    for (unsigned node : ids)
+    {
+        std::string cpus;
+        if (!readSysfsLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", cpus))
+            continue;
+        for (unsigned id : parseSysfsList(cpus))
+        {
+            if (id == cpu)
+                return (int)node;
+        }
+    }
+#else
+    (void)cpu;
+#endif
+    return -1;
+}
+
+/*
+ * scans /sys/devices/system/cpu/cpu<N>/{topology,cache}. Cores and L3 domains are
+ * renumbered in order of their first CPU. Where it's not available every CPU is
+ * taken as its own core, all sharing one L3.
+ */
+std::vector<CpuTopology> scanCpuTopology()
+{
+    std::vector<CpuTopology> topology;
+
+#if defined(__linux__)
+    std::string online;
+    if (readSysfsLine("/sys/devices/system/cpu/online", online))
+    {
+        const std::string sysfs = "/sys/devices/system/cpu/cpu";
+        std::map<std::pair<unsigned, unsigned>, unsigned> cores;  // (package, core id) -> core
+        std::map<std::string, unsigned> l3Domains;                // shared CPU list -> domain
+
+        for (unsigned cpu : parseSysfsList(online))
+        {
+            const std::string dir = sysfs + std::to_string(cpu);
+            CpuTopology t{cpu, 0, 0, getCpuNumaNode(cpu), true};
+
+            std::string package, coreId, siblings;
+            if (readSysfsLine(dir + "/topology/physical_package_id", package) &&
+                readSysfsLine(dir + "/topology/core_id", coreId))
+            {
+                auto key = std::make_pair((unsigned)std::stoul(package), (unsigned)std::stoul(coreId));
+                t.core = cores.emplace(key, (unsigned)cores.size()).first->second;
+            }
+            else
+            {
+                t.core = (unsigned)cores.size();
+                cores.emplace(std::make_pair(~0u, cpu), t.core);
+            }
+
+            if (readSysfsLine(dir + "/topology/thread_siblings_list", siblings))
+            {
+                auto ids = parseSysfsList(siblings);
+                t.primaryThread = ids.empty() || ids.front() == cpu;
+            }
+
+            // The L3 is the last level on all the CPUs we care about, look for it by level
+            // as the index of the last level varies
+            for (unsigned index = 0;; index++)
+            {
+                std::string level, shared;
+                const std::string cache = dir + "/cache/index" + std::to_string(index);
+                if (!readSysfsLine(cache + "/level", level))
+                    break;
+                if (level == "3" && readSysfsLine(cache + "/shared_cpu_list", shared))
+                {
+                    t.l3 = l3Domains.emplace(shared, (unsigned)l3Domains.size()).first->second;
+                    break;
+                }
+            }
+
+            topology.push_back(t);
+        }
+    }
+#endif
+
+    if (topology.empty())
+    {
+        unsigned cpus = std::thread::hardware_concurrency();
+        for (unsigned cpu = 0; cpu < cpus; cpu++)
+            topology.push_back({cpu, cpu, 0, -1, true});
+    }
+    return topology;
+}
+
+}  // namespace eth
+}  // namespace dev
@@ -0,0 +1,47 @@
+/*
+This file is part of firominer.
+
+firominer is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+firominer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with firominer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace dev
+{
+namespace eth
+{
+// Where a logical CPU sits in the machine
+struct CpuTopology
+{
+    unsigned cpu;        // Logical CPU number
+    unsigned core;       // Physical core, numbered from 0 across all packages
+    unsigned l3;         // L3 cache domain, numbered from 0
+    int numaNode;        // NUMA node, -1 if unknown or if there's only one node
+    bool primaryThread;  // First SMT thread of its core
+};
+
+// Parses a sysfs list of ids such as "0-3,8-11"
+std::vector<unsigned> parseSysfsList(const std::string& list);
+
+// Returns the NUMA node of a CPU or -1 if unknown or if there's only one node
+int getCpuNumaNode(unsigned cpu);
+
+// Scans the topology of the online CPUs, ordered by CPU number
+std::vector<CpuTopology> scanCpuTopology();
+
+}  // namespace eth
+}  // namespace dev
@@ -41,8 +41,7 @@ struct CUDAChannel : public LogChannel
 CUDAMiner::CUDAMiner(unsigned _index, CUSettings _settings, DeviceDescriptor& _device)
   : Miner("cuda-", _index),
     m_settings(_settings),
-    m_batch_size(_settings.gridSize * _settings.blockSize),
-    m_streams_batch_size(_settings.gridSize * _settings.blockSize * _settings.streams)
+    m_batch_size(_settings.gridSize * _settings.blockSize)
 {
     m_deviceDescriptor = _device;
 }
@@ -190,8 +189,6 @@ bool CUDAMiner::initEpoch_internal()
 
 void CUDAMiner::workLoop()
 {
-    WorkPackage current;
-    current.header = h256();
     uint64_t old_period_seed = -1;
     int old_epoch = -1;
 
@@ -203,18 +200,18 @@ void CUDAMiner::workLoop()
 
     try
     {
+        uint64_t generation = 0;
         while (!shouldStop())
         {
-            // Wait for work
-            bool new_work_expected{true};
-            if (!m_new_work.compare_exchange_strong(new_work_expected, false))
+            // Wait for new work, a pause or a stop
+            if (workGeneration() == generation)
             {
-                std::unique_lock l(x_work);
-                m_new_work_signal.wait_for(l, std::chrono::milliseconds(50));
+                waitForWakeUp();
                 continue;
             }
 
-            const WorkPackage w = work();
+            const auto wp = work(generation);
+            const WorkPackage& w = *wp;
             if (!w)
             {
                 continue;
@@ -226,7 +223,7 @@ void CUDAMiner::workLoop()
                     break;  // This will simply exit the thread
                 }
                 old_epoch = static_cast<int>(w.epoch.value());
-                if (m_new_work.load())
+                if (workGeneration() != generation)
                 {
                     continue;
                 }
@@ -292,13 +289,10 @@ void CUDAMiner::workLoop()
                 }));
             }
 
-            // Persist most recent job.
-            // Job's differences should be handled at higher level
-            current = w;
             uint64_t upper64OfBoundary = (uint64_t)(u64)((u256)w.get_boundary() >> 192);
 
             // Eventually start searching
-            search(current.header.data(), upper64OfBoundary, current.startNonce, w);
+            search(w.header.data(), upper64OfBoundary, w, generation);
         }
 
         // Reset miner and stop working
@@ -314,8 +308,7 @@ void CUDAMiner::workLoop()
 
 void CUDAMiner::kick_miner()
 {
-    m_new_work.store(true, std::memory_order_relaxed);
-    m_new_work_signal.notify_one();
+    wakeUp();
 }
 
 int CUDAMiner::getNumDevices()
@@ -498,7 +491,7 @@ void CUDAMiner::compileKernel(uint64_t period_seed, uint64_t dag_elms, CUfunctio
             << to_string(m_deviceDescriptor.cuComputeMajor) << '.' << to_string(m_deviceDescriptor.cuComputeMinor);
 }
 
-void CUDAMiner::search(uint8_t const* header, uint64_t target, uint64_t start_nonce, const dev::eth::WorkPackage& w)
+void CUDAMiner::search(uint8_t const* header, uint64_t target, const dev::eth::WorkPackage& w, uint64_t generation)
 {
     set_header(*reinterpret_cast<hash32_t const*>(header));
     if (m_current_target != target)
@@ -521,10 +514,16 @@ void CUDAMiner::search(uint8_t const* header, uint64_t target, uint64_t start_no
 
     auto search_start = std::chrono::steady_clock::now();
 
-    // prime each stream, clear search result buffers and start the search
+    // prime each stream with nonces claimed from the job, clear search result
+    // buffers and start the search
+    std::vector<NonceRange> ranges(m_settings.streams);
     uint32_t current_index;
-    for (current_index = 0; current_index < m_settings.streams; current_index++, start_nonce += m_batch_size)
+    for (current_index = 0; current_index < m_settings.streams; current_index++)
     {
+        if (!w.nonces->claim(m_index, m_batch_size, ranges[current_index]))
+            break;
+        uint64_t start_nonce = ranges[current_index].first;
+
         cudaStream_t stream = m_streams[current_index];
         volatile Search_results& buffer(*m_search_buf[current_index]);
         buffer.count = 0;
@@ -550,29 +549,32 @@ void CUDAMiner::search(uint8_t const* header, uint64_t target, uint64_t start_no
 
     while (!done)
     {
-        // Exit next time around if there's new work awaiting
-        done = (done || m_new_work.load() || paused());
+        // Exit next time around if there's new work awaiting (pausing publishes void work)
+        done = (done || workGeneration() != generation);
 
         //// Check on every batch if we need to suspend mining
         // if (!done)
         //    done = paused();
 
         // This inner loop will process each cuda stream individually
-        for (current_index = 0; current_index < m_settings.streams; current_index++, start_nonce += m_batch_size)
+        uint32_t completed = 0;
+        uint32_t running = 0;
+        for (current_index = 0; current_index < m_settings.streams; current_index++)
         {
             // Each pass of this loop will wait for a stream to exit,
             // save any found solutions, then restart the stream
             // on the next group of nonces.
+            NonceRange& range = ranges[current_index];
+            if (!range.count)
+                continue;  // Idle, the nonces of the job ran out
+
             cudaStream_t stream = m_streams[current_index];
 
             // Wait for the stream complete
             CUDA_SAFE_CALL(cudaStreamSynchronize(stream));
 
             if (shouldStop())
-            {
-                m_new_work.store(false, std::memory_order_relaxed);
                 done = true;
-            }
 
             // Detect solutions in current stream's solution buffer
             volatile Search_results& buffer(*m_search_buf[current_index]);
@@ -594,8 +596,13 @@ void CUDAMiner::search(uint8_t const* header, uint64_t target, uint64_t start_no
 
             // restart the stream on the next batch of nonces
             // unless we are done for this round.
-            if (!done)
+            const NonceRange searched = range;
+            range.count = 0;
+            completed++;
+            if (!done && w.nonces->claim(m_index, m_batch_size, range))
             {
+                running++;
+                uint64_t start_nonce = range.first;
                 volatile Search_results* Buffer = &buffer;
                 bool hack_false = false;
                 void* args[] = {&start_nonce, &current_header, &m_current_target, &dag, &Buffer, &hack_false};
@@ -608,10 +615,12 @@ void CUDAMiner::search(uint8_t const* header, uint64_t target, uint64_t start_no
             }
             if (found_count)
             {
-                uint64_t nonce_base = start_nonce - m_streams_batch_size;
                 for (uint32_t i = 0; i < found_count; i++)
                 {
-                    uint64_t nonce = nonce_base + gids[i];
+                    // A batch overruns a short range, those nonces were handed to others
+                    if (gids[i] >= searched.count)
+                        continue;
+                    uint64_t nonce = searched.first + gids[i];
                     Farm::f().submitProof(Solution{nonce, mixHashes[i], w, std::chrono::steady_clock::now(), m_index});
 
                     double d = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -625,14 +634,15 @@ void CUDAMiner::search(uint8_t const* header, uint64_t target, uint64_t start_no
         }
 
         // Update the hash rate
-        updateHashRate(m_batch_size, m_settings.streams);
+        updateHashRate(m_batch_size, completed);
+
+        // Nothing left to wait for once no stream could be restarted
+        if (!running)
+            done = true;
 
         // Bail out if it's shutdown time
         if (shouldStop())
-        {
-            m_new_work.store(false, std::memory_order_relaxed);
             break;
-        }
     }
 
 #ifdef DEV_BUILD
@@ -37,8 +37,7 @@ public:
     static int getNumDevices();
     static void enumDevices(std::map<std::string, DeviceDescriptor>& _DevicesCollection);
 
-    void search(
-        uint8_t const* header, uint64_t target, uint64_t _startN, const dev::eth::WorkPackage& w);
+    void search(uint8_t const* header, uint64_t target, const dev::eth::WorkPackage& w, uint64_t generation);
 
 protected:
     bool initDevice() override;
@@ -48,8 +47,6 @@ protected:
     void kick_miner() override;
 
 private:
-    std::atomic<bool> m_new_work = {false};
-
     void workLoop() override;
 
     uint8_t m_kernelCompIx = 0;
@@ -62,7 +59,6 @@ private:
     CUSettings m_settings;
 
     const uint32_t m_batch_size;
-    const uint32_t m_streams_batch_size;
 
     uint64_t m_allocated_memory_dag = 0; // dag_size is a uint64_t in EpochContext struct
     size_t m_allocated_memory_light_cache = 0;
@@ -32,12 +32,50 @@
 
 #include <libcrypto/progpow.hpp>
 
+#if defined(__linux__) || defined(__APPLE__)
+#include <time.h>
+#include <unistd.h>
+#endif
+
 namespace dev
 {
 namespace eth
 {
 Farm* Farm::m_this = nullptr;
 
+namespace
+{
+// CPU time consumed by the calling thread, in microseconds. 0 where unsupported
+uint64_t threadCpuMicros()
+{
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+        return uint64_t(ts.tv_sec) * 1000000 + uint64_t(ts.tv_nsec) / 1000;
+#endif
+    return 0;
+}
+
+// Physical memory currently available on the host. 0 if unknown
+size_t availableHostMemory()
+{
+#if defined(_SC_AVPHYS_PAGES) && defined(_SC_PAGESIZE)
+    long pages = sysconf(_SC_AVPHYS_PAGES);
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && pageSize > 0)
+        return size_t(pages) * size_t(pageSize);
+#endif
+    return 0;
+}
+
+// Whether the host can spare _needed bytes and still keep some headroom. True if unknown
+bool hostMemoryFits(size_t _needed)
+{
+    size_t available = availableHostMemory();
+    return !available || _needed + (size_t(256) << 20) <= available;
+}
+}  // namespace
+
 Farm::Farm(std::map<std::string, DeviceDescriptor>& _DevicesCollection, FarmSettings _settings, CUSettings _CUSettings,
     CLSettings _CLSettings, CPSettings _CPSettings)
   : m_Settings(std::move(_settings)),
@@ -50,6 +88,9 @@ Farm::Farm(std::map<std::string, DeviceDescriptor>& _DevicesCollection, FarmSett
 {
     m_this = this;
 
+    if (m_Settings.verifyMode == "off")
+        m_Settings.noEval = true;
+
     // Init HWMON if needed
     if (m_Settings.hwMon)
     {
@@ -142,6 +183,18 @@ Farm::Farm(std::map<std::string, DeviceDescriptor>& _DevicesCollection, FarmSett
         }
     }
 
+    // Verification of solutions stays off the io thread. Outcomes are brought
+    // back to the strand, in the order of completion, to be accounted and submitted
+    if (!m_Settings.noEval)
+        m_verifier.reset(new SolutionVerifier(
+            m_Settings.verifyThreads,
+            [this](const std::vector<Solution>& _s, std::vector<SolutionCheck>& _checks) {
+                verifySolutions(_s, _checks);
+            },
+            [this](const Solution& _s, SolutionCheck _check) {
+                m_io_strand.post(boost::bind(&Farm::submitProofAsync, this, _s, _check));
+            }));
+
     // Initialize nonce_scrambler
     shuffle();
 
@@ -158,6 +211,9 @@ Farm::~Farm()
     // Stop data collector (before monitors !!!)
     m_collectTimer.cancel();
 
+    // Stop verifying solutions
+    m_verifier.reset();
+
     // Deinit HWMON
 #if defined(__linux)
     if (sysfsh)
@@ -189,7 +245,6 @@ void Farm::shuffle()
 
 void Farm::setWork(WorkPackage const& _newWp)
 {
-    // Set work to each miner giving it's own starting nonce
     Guard l(x_minerWork);
 
     // Discard if we don't have an epoch
@@ -198,14 +253,169 @@ void Farm::setWork(WorkPackage const& _newWp)
         return;
     }
 
-    if (!m_currentEc || m_currentEc->epoch_number != _newWp.epoch.value())
+    const uint32_t epoch = _newWp.epoch.value();
+    if (!m_currentEc || m_currentEc->epoch_number != epoch)
     {
-        m_currentEc.reset();
-        m_currentEc = ethash::get_epoch_context(_newWp.epoch.value(), false);
-        for (auto const& miner : m_miners)
-            miner->setEpoch(m_currentEc);
+        // Built ahead of the epoch boundary, switch right away
+        if (auto ec = getPrebuiltContext(epoch))
+        {
+            m_pendingEpoch = ~0U;
+            switchEpoch(ec);
+            applyWork(_newWp);
+            return;
+        }
+
+        // The light cache takes hundreds of ms to build: it's done in background
+        // while this (network) thread goes on. Jobs of the new epoch are held
+        // meanwhile, the newest one is handed to miners once the context is ready
+        m_pendingWp = _newWp;
+        if (m_pendingEpoch != epoch)
+        {
+            m_pendingEpoch = epoch;
+            ethash::get_epoch_context_async(
+                epoch, false, [this, epoch](const std::shared_ptr<ethash::epoch_context>& _ec) {
+                    m_io_strand.post(boost::bind(&Farm::epochContextReady, this, epoch, _ec));
+                });
+        }
+        return;
+    }
+
+    // Back to the current epoch, forget about the one being built
+    m_pendingEpoch = ~0U;
+
+    applyWork(_newWp);
+}
+
+void Farm::epochContextReady(uint32_t _epoch, std::shared_ptr<ethash::epoch_context> _ec)
+{
+    Guard l(x_minerWork);
+
+    // Superseded by a job of another epoch
+    if (m_pendingEpoch != _epoch)
+        return;
+    m_pendingEpoch = ~0U;
+
+    if (!_ec)
+    {
+        cwarn << "Could not build the context of epoch " << _epoch;
+        return;
+    }
+
+    switchEpoch(_ec);
+    applyWork(m_pendingWp);
+}
+
+void Farm::switchEpoch(std::shared_ptr<ethash::epoch_context> const& _ec)
+{
+    m_currentEc = _ec;
+    for (auto const& miner : m_miners)
+        miner->setEpoch(m_currentEc);
+
+    if (m_Settings.verifyMode == "full" && !m_Settings.noEval)
+        buildVerifyDag(_ec->epoch_number);
+}
+
+void Farm::schedulePrebuild(WorkPackage const& _wp)
+{
+    if (!m_Settings.prebuildBlocks || !_wp.block.has_value() || !_wp.epoch.has_value())
+        return;
+
+    // Firo epochs are a fixed number of blocks, the height tells how far the next one is
+    const uint64_t block = _wp.block.value();
+    const uint64_t blocksLeft = ethash::kEpoch_length - block % ethash::kEpoch_length;
+    if (blocksLeft > m_Settings.prebuildBlocks)
+        return;
+    const uint32_t next = ethash::calculate_epoch_from_block_num(block + blocksLeft);
+
+    auto prebuild = m_prebuild;
+    {
+        std::lock_guard<std::mutex> l(prebuild->mutex);
+        if (prebuild->epoch == next)
+            return;
+        // Releases the pins of the previous prebuild, now in use (or not needed)
+        prebuild->epoch = next;
+        prebuild->light.reset();
+        prebuild->dags.clear();
+    }
+
+    // Host DAGs whoever will need them at the boundary: full verification and
+    // CPU miners, which have one per NUMA node
+    std::vector<int> dagNodes;
+    if (m_Settings.verifyMode == "full" && !m_Settings.noEval)
+        dagNodes.push_back(-1);
+    for (auto const& miner : m_miners)
+    {
+        const DeviceDescriptor& descriptor = miner->getDescriptor();
+        if (descriptor.type != DeviceTypeEnum::Cpu)
+            continue;
+        int node = descriptor.cpNumaNode;
+        if (std::find(dagNodes.begin(), dagNodes.end(), node) == dagNodes.end())
+            dagNodes.push_back(node);
+    }
+
+    // Current DAGs stay in use until the boundary, so the next ones come on top
+    if (!dagNodes.empty())
+    {
+        size_t needed = dagNodes.size() *
+                        ethash::get_full_dataset_size(ethash::calculate_full_dataset_num_items(next));
+        if (!hostMemoryFits(needed))
+        {
+            cnote << "Not enough host memory to build the DAG of epoch " << next << " ahead";
+            dagNodes.clear();
+        }
     }
 
+    cnote << "Epoch " << next << " in " << blocksLeft << " blocks. Building its context ahead";
+    std::thread([prebuild, next, dagNodes]() {
+        setThreadName("prebuild");
+        lowerThreadPriority(ThreadPriority::Idle);
+
+        auto start = std::chrono::steady_clock::now();
+        auto light = ethash::get_epoch_context(next, false);
+        if (!light)
+        {
+            cwarn << "Could not build the context of epoch " << next << " ahead";
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> l(prebuild->mutex);
+            if (prebuild->epoch != next)
+                return;
+            prebuild->light = light;
+        }
+
+        for (int node : dagNodes)
+        {
+            auto dag = node >= 0 ? ethash::get_numa_epoch_context(next, unsigned(node)) :
+                                   ethash::get_epoch_context(next, true);
+            if (!dag)
+                continue;  // Miners will try again at the boundary
+            std::lock_guard<std::mutex> l(prebuild->mutex);
+            if (prebuild->epoch != next)
+                return;
+            prebuild->dags.push_back(dag);
+        }
+
+        cnote << "Epoch " << next << " context built ahead in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start)
+                     .count()
+              << " ms";
+    }).detach();
+}
+
+std::shared_ptr<ethash::epoch_context> Farm::getPrebuiltContext(uint32_t _epoch)
+{
+    std::lock_guard<std::mutex> l(m_prebuild->mutex);
+    if (m_prebuild->epoch != _epoch)
+        return nullptr;
+    return m_prebuild->light;
+}
+
+void Farm::applyWork(WorkPackage const& _newWp)
+{
+    schedulePrebuild(_newWp);
+
+    // Set work to each miner giving it's own starting nonce
     m_currentWp = _newWp;
 
     // Check if we need to shuffle per work (ergodicity == 2)
@@ -213,11 +423,13 @@ void Farm::setWork(WorkPackage const& _newWp)
         shuffle();
 
     uint64_t _startNonce;
+    unsigned _spaceBits = 64;
     if (m_currentWp.exSizeBytes > 0)
     {
-        // Equally divide the residual segment among miners
+        // The residual segment is all there is
         _startNonce = m_currentWp.startNonce;
-        m_nonce_segment_with = (unsigned int)log2(pow(2, 64 - (m_currentWp.exSizeBytes * 4)) / m_miners.size());
+        _spaceBits = (m_currentWp.exSizeBytes * 4 < 64) ? 64 - m_currentWp.exSizeBytes * 4 : 0;
+        m_nonce_segment_with = (unsigned int)log2(pow(2, _spaceBits) / m_miners.size());
     }
     else
     {
@@ -225,9 +437,18 @@ void Farm::setWork(WorkPackage const& _newWp)
         _startNonce = m_nonce_scrambler;
     }
 
+    // Miners get nonces in proportion of their hashrate and the ones running out
+    // take over from the others. Paused ones get none up front
+    std::vector<float> hashrates;
+    for (auto const& miner : m_miners)
+        hashrates.push_back(miner->paused() ? -1.0f : miner->RetrieveHashRate());
+    m_currentWp.nonces =
+        std::make_shared<NonceAllocator>(_startNonce, _spaceBits, m_nonce_segment_with, hashrates);
+
+    auto coverage = m_currentWp.nonces->coverage();
     for (unsigned int i = 0; i < m_miners.size(); i++)
     {
-        m_currentWp.startNonce = _startNonce + ((uint64_t)i << m_nonce_segment_with);
+        m_currentWp.startNonce = coverage.lanes.at(i).next;
         m_miners.at(i)->setWork(m_currentWp);
     }
 }
@@ -457,9 +678,37 @@ Json::Value Farm::get_nonce_scrambler_json()
     jRes["device_width"] = m_nonce_segment_with;
     jRes["device_count"] = (uint64_t)m_miners.size();
 
+    NonceCoverage coverage = getNonceCoverage();
+    Json::Value jCoverage;
+    jCoverage["start_nonce"] = toHex(coverage.start, HexPrefix::Add);
+    jCoverage["space_width"] = coverage.spaceBits;
+    jCoverage["claimed"] = coverage.claimed;
+    jCoverage["steals"] = coverage.steals;
+    jCoverage["exhausted"] = coverage.exhausted;
+    Json::Value jLanes(Json::arrayValue);
+    for (auto const& lane : coverage.lanes)
+    {
+        Json::Value jLane;
+        jLane["next"] = toHex(lane.next, HexPrefix::Add);
+        jLane["end"] = toHex(lane.end, HexPrefix::Add);
+        jLane["claimed"] = lane.claimed;
+        jLane["steals"] = lane.steals;
+        jLanes.append(jLane);
+    }
+    jCoverage["devices"] = jLanes;
+    jRes["coverage"] = jCoverage;
+
     return jRes;
 }
 
+NonceCoverage Farm::getNonceCoverage()
+{
+    Guard l(x_minerWork);
+    if (m_currentWp.nonces)
+        return m_currentWp.nonces->coverage();
+    return NonceCoverage();
+}
+
 void Farm::setTStartTStop(unsigned tstart, unsigned tstop)
 {
     m_Settings.tempStart = tstart;
@@ -468,63 +717,218 @@ void Farm::setTStartTStop(unsigned tstart, unsigned tstop)
 
 void Farm::submitProof(Solution const& _s)
 {
-    g_io_service.post(m_io_strand.wrap(boost::bind(&Farm::submitProofAsync, this, _s)));
+    if (m_verifier)
+        m_verifier->submit(_s);
+    else
+        m_io_strand.post(boost::bind(&Farm::submitProofAsync, this, _s, SolutionCheck::Valid));
 }
 
-void Farm::submitProofAsync(Solution const& _s)
+VerifierStats Farm::getVerifierStats()
 {
-    if (!m_Settings.noEval)
+    VerifierStats stats;
+    if (m_verifier)
+        stats = m_verifier->stats();
+
+    // Verification shares the light context of the current epoch with the farm
+    Guard l(x_minerWork);
+    if (m_currentEc)
     {
-        bool validSolution{false};
+        auto cache = ethash::get_dataset_item_cache_stats(*m_currentEc);
+        stats.cacheHits = cache.hits;
+        stats.cacheMisses = cache.misses;
+        stats.fullReady = getVerifyDag(m_currentEc->epoch_number) != nullptr;
+    }
 
-        if (_s.work.algo == "ethash")
+    stats.mode = m_Settings.noEval ? "off" : m_Settings.verifyMode;
+    VerifierStats::Backend* backends[2] = {&stats.light, &stats.full};
+    for (unsigned i = 0; i < 2; i++)
+    {
+        backends[i]->verified = m_verifyCost[i].verified.load(std::memory_order_relaxed);
+        if (backends[i]->verified)
         {
-            auto result = ethash::verify_full(*m_currentEc.get(), ethash::from_bytes(_s.work.header.data()),
-                ethash::from_bytes(_s.mixHash.data()), _s.nonce, ethash::from_bytes(_s.work.get_boundary().data()));
-            switch (result)
-            {
-            case ethash::VerificationResult::kInvalidNonce:
-                cwarn << "Solution not below boundary";
-                break;
-            case ethash::VerificationResult::kInvalidMixHash:
-                cwarn << "Solution mix mismatch";
-                break;
-            default:
-                validSolution = true;
-                break;
-            }
+            backends[i]->avgMicros =
+                m_verifyCost[i].wallMicros.load(std::memory_order_relaxed) / backends[i]->verified;
+            backends[i]->avgCpuMicros =
+                m_verifyCost[i].cpuMicros.load(std::memory_order_relaxed) / backends[i]->verified;
         }
+    }
+    return stats;
+}
 
-        if (_s.work.algo == "progpow")
+void Farm::buildVerifyDag(uint32_t _epoch)
+{
+    auto dag = m_verifyDag;
+    {
+        std::lock_guard<std::mutex> l(dag->mutex);
+        if (dag->epoch == _epoch)
+            return;
+        dag->epoch = _epoch;
+        dag->context.reset();  // Unpins the previous epoch's DAG
+    }
+
+    // Building the DAG on a host short of memory would fail, keep verifying with the light cache
+    size_t needed = ethash::get_full_dataset_size(ethash::calculate_full_dataset_num_items(_epoch));
+    if (!hostMemoryFits(needed))
+    {
+        cwarn << "Not enough host memory for the verification DAG of epoch " << _epoch << " ("
+              << dev::getFormattedMemory(double(needed)) << " needed). Verifying in light mode";
+        return;
+    }
+
+    // Verification goes on with the light context meanwhile. The thread keeps the
+    // shared state alive, thus may outlive the farm
+    std::thread([dag, _epoch]() {
+        setThreadName("vdag");
+        auto start = std::chrono::steady_clock::now();
+        auto context = ethash::get_epoch_context(_epoch, true);
+        if (!context)
         {
-            auto period{_s.work.block.value() / progpow::kPeriodLength};
+            cwarn << "Could not build the verification DAG of epoch " << _epoch << ", verifying light";
+            return;
+        }
+        std::lock_guard<std::mutex> l(dag->mutex);
+        if (dag->epoch != _epoch)
+            return;  // Superseded by a newer epoch
+        dag->context = context;
+        cnote << "Verification DAG of epoch " << _epoch << " ready in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start)
+                     .count()
+              << " ms";
+    }).detach();
+}
+
+std::shared_ptr<ethash::epoch_context> Farm::getVerifyDag(uint32_t _epoch)
+{
+    std::lock_guard<std::mutex> l(m_verifyDag->mutex);
+    if (m_verifyDag->epoch != _epoch)
+        return nullptr;
+    return m_verifyDag->context;
+}
 
-            ethash::hash256 header_256{ethash::from_bytes(_s.work.header.data())};
-            ethash::hash256 mix_256{ethash::from_bytes(_s.mixHash.data())};
-            ethash::hash256 boundary_256{ethash::from_bytes(_s.work.get_boundary().data())};
+void Farm::accountVerifyCost(
+    bool _full, size_t _count, std::chrono::steady_clock::time_point _start, uint64_t _cpuStart)
+{
+    VerifyCost& cost = m_verifyCost[_full ? 1 : 0];
+    cost.verified.fetch_add(_count, std::memory_order_relaxed);
+    cost.wallMicros.fetch_add(uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(
+                                           std::chrono::steady_clock::now() - _start)
+                                           .count()),
+        std::memory_order_relaxed);
+    cost.cpuMicros.fetch_add(threadCpuMicros() - _cpuStart, std::memory_order_relaxed);
+}
 
-            auto result = progpow::verify_full(_s.work.block.value(), header_256, mix_256, _s.nonce, boundary_256);
-            switch (result)
+void Farm::verifySolutions(std::vector<Solution> const& _solutions, std::vector<SolutionCheck>& _checks)
+{
+    std::vector<ethash::VerificationResult> results(
+        _solutions.size(), ethash::VerificationResult::kInvalidMixHash);
+    std::vector<bool> done(_solutions.size(), false);
+    std::vector<bool> unverified(_solutions.size(), false);
+
+    for (size_t i = 0; i < _solutions.size(); i++)
+    {
+        const Solution& s = _solutions[i];
+        if (done[i])
+            continue;
+        done[i] = true;
+
+        if (s.work.algo == "ethash")
+        {
+            // The epoch context of the solution's work, not the farm's current one
+            // which setWork() may be swapping meanwhile
+            auto context{getVerifyDag(s.work.epoch.value())};
+            bool full = context != nullptr;
+            if (!full)
+                context = ethash::get_epoch_context(s.work.epoch.value(), false);
+            if (!context)
             {
-            case ethash::VerificationResult::kInvalidNonce:
-                cwarn << "Solution not below boundary";
-                break;
-            case ethash::VerificationResult::kInvalidMixHash:
-                cwarn << "Solution mix mismatch";
-                break;
-            default:
-                validSolution = true;
-                break;
+                // The host ran short of memory, the miner is not to blame
+                cwarn << "No context to verify solutions of epoch " << s.work.epoch.value()
+                      << ", submitting unverified";
+                unverified[i] = true;
+                continue;
             }
+
+            auto start = std::chrono::steady_clock::now();
+            uint64_t cpuStart = threadCpuMicros();
+            results[i] = ethash::verify_full(*context, ethash::from_bytes(s.work.header.data()),
+                ethash::from_bytes(s.mixHash.data()), s.nonce, ethash::from_bytes(s.work.get_boundary().data()));
+            accountVerifyCost(full, 1, start, cpuStart);
         }
+        else if (s.work.algo == "progpow")
+        {
+            // All the solutions of the same block share epoch and program
+            const uint64_t block = s.work.block.value();
+            std::vector<size_t> indexes;
+            std::vector<progpow::share> shares;
+            for (size_t j = i; j < _solutions.size(); j++)
+            {
+                const Solution& o = _solutions[j];
+                if (o.work.algo != "progpow" || o.work.block.value() != block)
+                    continue;
+                done[j] = true;
+                indexes.push_back(j);
+                shares.push_back({ethash::from_bytes(o.work.header.data()), ethash::from_bytes(o.mixHash.data()),
+                    o.nonce, ethash::from_bytes(o.work.get_boundary().data())});
+            }
 
-        if (!validSolution)
+            // The pool already spreads over threads, verify on this one
+            const uint32_t epoch = ethash::calculate_epoch_from_block_num(block);
+            auto context{getVerifyDag(epoch)};
+            bool full = context != nullptr;
+            if (!full)
+                context = ethash::get_epoch_context(epoch, false);
+            if (!context)
+            {
+                cwarn << "No context to verify solutions of epoch " << epoch << ", submitting unverified";
+                for (size_t k : indexes)
+                    unverified[k] = true;
+                continue;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            uint64_t cpuStart = threadCpuMicros();
+            auto batch{progpow::verify_batch(
+                *context, uint32_t(block / progpow::kPeriodLength), shares.data(), shares.size(), 1)};
+            accountVerifyCost(full, shares.size(), start, cpuStart);
+            for (size_t k = 0; k < indexes.size(); k++)
+                results[indexes[k]] = batch[k];
+        }
+    }
+
+    for (size_t i = 0; i < _solutions.size(); i++)
+    {
+        if (unverified[i])
         {
-            accountSolution(_s.midx, SolutionAccountingEnum::Failed);
-            cwarn << "GPU " << _s.midx << " gave incorrect " << _s.work.algo
-                  << " result. Lower overclocking values if it happens frequently.";
-            return;
+            _checks[i] = SolutionCheck::Unverified;
+            continue;
         }
+        switch (results[i])
+        {
+        case ethash::VerificationResult::kOk:
+            _checks[i] = SolutionCheck::Valid;
+            break;
+        case ethash::VerificationResult::kInvalidNonce:
+            cwarn << "Solution not below boundary";
+            _checks[i] = SolutionCheck::Invalid;
+            break;
+        default:
+            if (_solutions[i].work.algo == "ethash" || _solutions[i].work.algo == "progpow")
+                cwarn << "Solution mix mismatch";
+            _checks[i] = SolutionCheck::Invalid;
+            break;
+        }
+    }
+}
+
+void Farm::submitProofAsync(Solution const& _s, SolutionCheck _check)
+{
+    // Unverified solutions go to the pool like with --noeval, it has the last word
+    if (_check == SolutionCheck::Invalid)
+    {
+        accountSolution(_s.midx, SolutionAccountingEnum::Failed);
+        cwarn << "GPU " << _s.midx << " gave incorrect " << _s.work.algo
+              << " result. Lower overclocking values if it happens frequently.";
+        return;
     }
 
     m_onSolutionFound(_s);
@@ -33,6 +33,7 @@
 #include <libdevcore/Worker.h>
 
 #include <libethcore/Miner.h>
+#include <libethcore/SolutionVerifier.h>
 
 #include <libhwmon/wrapnvml.h>
 #if defined(__linux)
@@ -52,10 +53,13 @@ struct FarmSettings
 {
     unsigned dagLoadMode = 0;  // 0 = Parallel; 1 = Serialized
     bool noEval = false;       // Whether or not to re-evaluate solutions
+    std::string verifyMode = "cached";  // light | cached | full | off (same as noEval)
     unsigned hwMon = 0;        // 0 - No monitor; 1 - Temp and Fan; 2 - Temp Fan Power
     unsigned ergodicity = 0;   // 0=default, 1=per session, 2=per job
     unsigned tempStart = 40;   // Temperature threshold to restart mining (if paused)
     unsigned tempStop = 0;     // Temperature threshold to pause mining (overheating)
+    unsigned verifyThreads = 0;  // Solution verification threads. 0 = auto
+    unsigned prebuildBlocks = 30;  // Blocks before an epoch boundary to build the next one. 0 = off
 };
 
 /**
@@ -229,6 +233,11 @@ public:
      */
     Json::Value get_nonce_scrambler_json();
 
+    /**
+     * @brief Gets how the nonces of the current job were handed out to miners
+     */
+    NonceCoverage getNonceCoverage();
+
     void setTStartTStop(unsigned tstart, unsigned tstop);
 
     unsigned get_tstart() override { return m_Settings.tempStart; }
@@ -245,12 +254,45 @@ public:
 
     bool getNoEval() { return m_Settings.noEval; }
 
+    /**
+     * @brief Gets the counters of the solution verification pool
+     */
+    VerifierStats getVerifierStats();
+
 private:
     std::atomic<bool> m_paused = {false};
 
+    // Re-evaluates solutions on the host, run by the verification pool
+    void verifySolutions(std::vector<Solution> const& _solutions, std::vector<SolutionCheck>& _checks);
+
+    // Adds the cost of verifying _count solutions started at _start / _cpuStart
+    void accountVerifyCost(
+        bool _full, size_t _count, std::chrono::steady_clock::time_point _start, uint64_t _cpuStart);
+
+    // Starts building the host DAG of an epoch for verification (verify mode full)
+    void buildVerifyDag(uint32_t _epoch);
+
+    // The host DAG of an epoch if it's built, otherwise nullptr
+    std::shared_ptr<ethash::epoch_context> getVerifyDag(uint32_t _epoch);
+
     // Async submits solution serializing execution
     // in Farm's strand
-    void submitProofAsync(Solution const& _s);
+    void submitProofAsync(Solution const& _s, SolutionCheck _check);
+
+    // Completes an epoch change once the context of the new epoch is built
+    void epochContextReady(uint32_t _epoch, std::shared_ptr<ethash::epoch_context> _ec);
+
+    // Hands a work package of the current epoch to miners. Requires x_minerWork
+    void applyWork(WorkPackage const& _newWp);
+
+    // Makes an epoch context the current one. Requires x_minerWork
+    void switchEpoch(std::shared_ptr<ethash::epoch_context> const& _ec);
+
+    // Starts building the next epoch when the work gets close enough to the boundary
+    void schedulePrebuild(WorkPackage const& _wp);
+
+    // The light context of an epoch if built ahead, otherwise nullptr
+    std::shared_ptr<ethash::epoch_context> getPrebuiltContext(uint32_t _epoch);
 
     // Collects data about hashing and hardware status
     void collectData(const boost::system::error_code& ec);
@@ -267,6 +309,21 @@ private:
     WorkPackage m_currentWp;
     std::shared_ptr<ethash::epoch_context> m_currentEc;
 
+    // Epoch whose context is being built (~0 if none) and its newest job
+    uint32_t m_pendingEpoch = ~0U;
+    WorkPackage m_pendingWp;
+
+    // Contexts of the next epoch built ahead, pinned until the one after. Shared
+    // with the thread building them
+    struct Prebuild
+    {
+        std::mutex mutex;
+        uint32_t epoch = ~0U;
+        std::shared_ptr<ethash::epoch_context> light;
+        std::vector<std::shared_ptr<ethash::epoch_context>> dags;
+    };
+    std::shared_ptr<Prebuild> m_prebuild = std::make_shared<Prebuild>();
+
     std::atomic<bool> m_isMining = {false};
 
     TelemetryType m_telemetry;  // Holds progress and status info for farm and miners
@@ -279,6 +336,26 @@ private:
     CLSettings m_CLSettings;  // OpenCL settings passed to CL Miner instantiator
     CPSettings m_CPSettings;  // CPU settings passed to CPU Miner instantiator
 
+    std::unique_ptr<SolutionVerifier> m_verifier;
+
+    // Host DAG used by verification in full mode. Shared with the thread building it
+    struct VerifyDag
+    {
+        std::mutex mutex;
+        uint32_t epoch = ~0U;
+        std::shared_ptr<ethash::epoch_context> context;
+    };
+    std::shared_ptr<VerifyDag> m_verifyDag = std::make_shared<VerifyDag>();
+
+    // Cost of verification per backend (0 light, 1 full)
+    struct VerifyCost
+    {
+        std::atomic<uint64_t> verified = {0};
+        std::atomic<uint64_t> wallMicros = {0};
+        std::atomic<uint64_t> cpuMicros = {0};
+    };
+    VerifyCost m_verifyCost[2];
+
     boost::asio::io_service::strand m_io_strand;
     boost::asio::deadline_timer m_collectTimer;
     const int m_collectInterval = 5000;
@@ -37,13 +37,9 @@ void Miner::setWork(WorkPackage const& _work)
 
         // Void work if this miner is paused
         if (paused())
-        {
-            m_work.header = h256();
-        }
+            publishWork(std::make_shared<const WorkPackage>());
         else
-        {
-            m_work = _work;
-        }
+            publishWork(std::make_shared<const WorkPackage>(_work));
 
 #ifdef DEV_BUILD
         m_workSwitchStart = std::chrono::steady_clock::now();
@@ -53,11 +49,24 @@ void Miner::setWork(WorkPackage const& _work)
     kick_miner();
 }
 
+void Miner::publishWork(std::shared_ptr<const WorkPackage> _work)
+{
+    // The package is stored before the generation is bumped: a miner seeing the
+    // new generation always gets the new package (or a newer one)
+    std::atomic_store(&m_work, std::move(_work));
+    m_workGeneration.fetch_add(1, std::memory_order_release);
+}
+
 void Miner::pause(MinerPauseEnum what)
 {
-    std::scoped_lock l(x_pause);
-    m_pauseFlags.set(what);
-    m_work.header = h256();
+    {
+        std::scoped_lock l(x_pause);
+        m_pauseFlags.set(what);
+    }
+    {
+        std::scoped_lock l(x_work);
+        publishWork(std::make_shared<const WorkPackage>());
+    }
     kick_miner();
 }
 
@@ -163,10 +172,10 @@ bool Miner::initEpoch()
     return result;
 }
 
-WorkPackage Miner::work() const
+std::shared_ptr<const WorkPackage> Miner::work(uint64_t& _generation) const
 {
-    std::scoped_lock l(x_work);
-    return m_work;
+    _generation = m_workGeneration.load(std::memory_order_acquire);
+    return std::atomic_load(&m_work);
 }
 
 void Miner::updateHashRate(uint32_t _groupSize, uint32_t _increment) noexcept
@@ -187,16 +196,7 @@ void Miner::updateHashRate(uint32_t _groupSize, uint32_t _increment) noexcept
 
 bool Miner::dropThreadPriority()
 {
-#if defined(__linux__)
-    // Non Posix hack to lower compile thread's priority. Under POSIX
-    // the nice value is a process attribute, under Linux it's a thread
-    // attribute
-    return nice(5) != -1;
-#elif defined(WIN32)
-    return SetThreadPriority(m_compileThread->native_handle(), THREAD_PRIORITY_BELOW_NORMAL);
-#else
-    return false;
-#endif
+    return lowerThreadPriority(ThreadPriority::BelowNormal);
 }
 
 }  // namespace dev::eth
@@ -23,6 +23,7 @@
 #include <bitset>
 #include <condition_variable>
 #include <list>
+#include <memory>
 #include <numeric>
 #include <optional>
 #include <string>
@@ -31,6 +32,7 @@
 #include <libdevcore/Common.h>
 #include <libdevcore/Log.h>
 #include <libdevcore/Worker.h>
+#include <libethcore/NonceAllocator.h>
 
 #include <boost/asio.hpp>
 #include <boost/format.hpp>
@@ -120,6 +122,13 @@ struct CLSettings : public MinerSettings
 // Holds settings for CPU Miner
 struct CPSettings : public MinerSettings
 {
+    unsigned threads = 0;                               // Mining threads, 0 one per subscribed CPU
+    std::string placement = "cores";                    // Thread placement policy (all, cores, l3)
+    unsigned reserveCores = 0;                          // Cores left free of mining threads
+    unsigned blockSize = 512;                           // Nonces hashed between checks for new work
+    bool jit = false;                                   // Compile ProgPoW programs to native code
+    std::string jitCompiler = "c++ -O3 -march=native";  // Compiler command for native programs
+    unsigned noncesInFlight = 0;                        // Nonces hashed interleaved, 0 tuned to the host
 };
 
 struct SolutionAccountType
@@ -204,7 +213,11 @@ struct DeviceDescriptor
     unsigned int cuComputeMajor;
     unsigned int cuComputeMinor;
 
-    int cpCpuNumer;  // For CPU
+    bool cpDetected;  // For CPU detected devices
+    int cpCpuNumer;
+    unsigned int cpCore;  // Physical core
+    unsigned int cpL3;    // L3 cache domain
+    int cpNumaNode;       // -1 if not NUMA
 };
 
 struct HwMonitorInfo
@@ -340,6 +353,8 @@ struct WorkPackage
     uint64_t startNonce = 0;
     uint16_t exSizeBytes = 0;
 
+    std::shared_ptr<NonceAllocator> nonces;  // Hands out the nonces of the job to the miners
+
     std::string algo = "progpow";
 };
 
@@ -479,9 +494,18 @@ protected:
     virtual bool initEpoch_internal() = 0;
 
     /**
-     * @brief Returns current workpackage this miner is working on
+     * @brief Returns the workpackage this miner is working on. The package is shared
+     * with the publisher and never modified, so it is neither locked nor copied
+     * @param _generation Receives the generation of the package
      */
-    WorkPackage work() const;
+    std::shared_ptr<const WorkPackage> work(uint64_t& _generation) const;
+
+    /**
+     * @brief Returns the generation of the workpackage, bumped on every new package
+     * and on pause. Search loops compare it to the one they work on to learn they
+     * should switch
+     */
+    uint64_t workGeneration() const { return m_workGeneration.load(std::memory_order_acquire); }
 
     void updateHashRate(uint32_t _groupSize, uint32_t _increment) noexcept;
 
@@ -504,15 +528,18 @@ protected:
     HwMonitorInfo m_hwmoninfo;
     mutable std::mutex x_work;
     mutable std::mutex x_pause;
-    std::condition_variable m_new_work_signal;
     std::condition_variable m_dag_loaded_signal;
     uint64_t m_nextProgpowPeriod = 0;
     std::unique_ptr<std::thread> m_compileThread = nullptr;
 
 private:
+    void publishWork(std::shared_ptr<const WorkPackage> _work);
+
     std::bitset<MinerPauseEnum::Pause_MAX> m_pauseFlags;
 
-    WorkPackage m_work;
+    // Replaced as a whole under x_work, read with std::atomic_load
+    std::shared_ptr<const WorkPackage> m_work = std::make_shared<const WorkPackage>();
+    std::atomic<uint64_t> m_workGeneration = {0};
 
     std::chrono::steady_clock::time_point m_hashTime = std::chrono::steady_clock::now();
     std::atomic<float> m_hashRate = {0.0};
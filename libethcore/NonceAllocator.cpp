@@ -0,0 +1,169 @@
+/*
+ This file is part of firominer.
+
+ firominer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ firominer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with firominer.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include <libdevcore/Log.h>
+#include <libethcore/NonceAllocator.h>
+
+namespace dev
+{
+namespace eth
+{
+NonceAllocator::NonceAllocator(
+    uint64_t _start, unsigned _spaceBits, unsigned _segmentBits, std::vector<float> const& _hashrates)
+  : m_lanes(std::max<size_t>(1, _hashrates.size())), m_start(_start), m_spaceBits(std::min(64U, _spaceBits))
+{
+    m_size = m_spaceBits < 64 ? (1ULL << m_spaceBits) : UINT64_MAX;
+    m_segment = std::max(1ULL, _segmentBits < 64 ? (1ULL << _segmentBits) : UINT64_MAX);
+
+    // A bounded space is split whole, the full one only a segment per miner to
+    // begin with, like the fixed segments used to be
+    uint64_t split = m_size;
+    if (m_spaceBits == 64 && m_segment <= m_size / m_lanes.size())
+        split = m_segment * m_lanes.size();
+
+    // Miners not measured yet get the average share, paused ones an empty lane
+    double known = 0;
+    unsigned measured = 0;
+    for (float h : _hashrates)
+        if (h > 0)
+        {
+            known += h;
+            measured++;
+        }
+    const double average = measured ? known / measured : 1.0;
+    std::vector<double> weights(m_lanes.size(), average);
+    for (size_t i = 0; i < _hashrates.size(); i++)
+        if (_hashrates[i] > 0)
+            weights[i] = _hashrates[i];
+        else if (_hashrates[i] < 0)
+            weights[i] = 0;
+
+    double total = 0;
+    for (double w : weights)
+        total += w;
+    double cumulated = 0;
+    uint64_t offset = 0;
+    for (size_t i = 0; i < m_lanes.size(); i++)
+    {
+        cumulated += weights[i];
+        uint64_t end = offset;
+        if (weights[i] > 0)
+            end = cumulated >= total ?
+                      split :
+                      std::min(split, std::max(offset, (uint64_t)((long double)split * (cumulated / total))));
+        m_lanes[i].next = offset;
+        m_lanes[i].end = end;
+        offset = end;
+    }
+
+    // With every miner paused nothing is split, they open segments once resumed
+    m_tail = offset;
+}
+
+bool NonceAllocator::claim(unsigned _lane, uint64_t _count, NonceRange& _range)
+{
+    std::lock_guard<std::mutex> l(x_lanes);
+    if (_lane >= m_lanes.size() || !_count)
+        return false;
+
+    Lane& lane = m_lanes[_lane];
+    if (lane.next == lane.end && !refill(_lane, _count))
+        return false;
+
+    _range.first = m_start + lane.next;
+    _range.count = std::min(_count, lane.end - lane.next);
+    lane.next += _range.count;
+    lane.claimed += _range.count;
+    m_claimed += _range.count;
+    return true;
+}
+
+bool NonceAllocator::refill(unsigned _lane, uint64_t _count)
+{
+    Lane& lane = m_lanes[_lane];
+
+    Lane* victim = nullptr;
+    for (auto& other : m_lanes)
+        if (&other != &lane && (!victim || other.end - other.next > victim->end - victim->next))
+            victim = &other;
+    uint64_t left = victim ? victim->end - victim->next : 0;
+
+    // Take over the upper half of the fullest lane, if worth at least a batch
+    if (left / 2 >= _count)
+    {
+        lane.next = victim->end - left / 2;
+        lane.end = victim->end;
+        victim->end = lane.next;
+        lane.steals++;
+        m_steals++;
+        return true;
+    }
+
+    // Then open a new segment
+    if (m_tail < m_size)
+    {
+        uint64_t size = std::min(m_segment, m_size - m_tail);
+        lane.next = m_tail;
+        lane.end = m_tail + size;
+        m_tail += size;
+        return true;
+    }
+
+    // Then share the leftovers, a miner may never claim its own (paused)
+    if (left)
+    {
+        lane.next = victim->end - (left + 1) / 2;
+        lane.end = victim->end;
+        victim->end = lane.next;
+        lane.steals++;
+        m_steals++;
+        return true;
+    }
+
+    if (!m_exhausted)
+    {
+        m_exhausted = true;
+        cwarn << "Nonce space of the job exhausted, waiting for a new one";
+    }
+    return false;
+}
+
+NonceCoverage NonceAllocator::coverage() const
+{
+    std::lock_guard<std::mutex> l(x_lanes);
+    NonceCoverage c;
+    c.start = m_start;
+    c.spaceBits = m_spaceBits;
+    c.claimed = m_claimed;
+    c.steals = m_steals;
+    c.exhausted = m_exhausted;
+    for (auto const& lane : m_lanes)
+    {
+        NonceCoverage::Lane cl;
+        cl.next = m_start + lane.next;
+        cl.end = m_start + lane.end;
+        cl.claimed = lane.claimed;
+        cl.steals = lane.steals;
+        c.lanes.push_back(cl);
+    }
+    return c;
+}
+
+}  // namespace eth
+}  // namespace dev
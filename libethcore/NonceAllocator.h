@@ -0,0 +1,117 @@
+/*
+ This file is part of firominer.
+
+ firominer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ firominer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with firominer.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace dev
+{
+namespace eth
+{
+/**
+ * @brief Nonces handed out to a miner: [first, first + count)
+ */
+struct NonceRange
+{
+    uint64_t first = 0;
+    uint64_t count = 0;
+
+    bool contains(uint64_t _nonce) const { return _nonce - first < count; }
+};
+
+struct NonceCoverage
+{
+    struct Lane
+    {
+        uint64_t next = 0;     // Next nonce handed out to the miner
+        uint64_t end = 0;      // End of the range left to the miner (exclusive)
+        uint64_t claimed = 0;  // Nonces handed out to the miner
+        unsigned steals = 0;   // Ranges the miner took over from others
+    };
+
+    uint64_t start = 0;       // First nonce of the space
+    unsigned spaceBits = 64;  // Width of the space as exponent of 2
+    uint64_t claimed = 0;     // Nonces handed out, each one once
+    unsigned steals = 0;
+    bool exhausted = false;   // Every nonce of the space was handed out
+    std::vector<Lane> lanes;
+};
+
+/**
+ * @brief Hands out the nonces of a job to the miners, never twice
+ *
+ * The space is split into one lane per miner, sized by the hashrate of the miner
+ * so they all run out at about the same time. Miners claim batches from their own
+ * lane. A miner whose lane runs out takes over the upper half of the lane with the
+ * most nonces left. Without an extranonce the space is 2^64 and new segments are
+ * opened instead of stealing slivers. With one (NiceHash) the space may be small
+ * and is eventually exhausted: miners then wait for the next job.
+ *
+ * @threadsafe
+ */
+class NonceAllocator
+{
+public:
+    /**
+     * @param _start       First nonce of the space
+     * @param _spaceBits   Width of the space as exponent of 2, 64 minus the bits of the extranonce
+     * @param _segmentBits Width of the segments opened per miner when the space is 2^64
+     * @param _hashrates   Hashrate of each miner, one lane each. 0 when not measured yet,
+     *                     which gets the average share. Negative for paused miners, which
+     *                     get an empty lane and take over from others once resumed
+     */
+    NonceAllocator(
+        uint64_t _start, unsigned _spaceBits, unsigned _segmentBits, std::vector<float> const& _hashrates);
+
+    /**
+     * @brief Claims up to _count nonces for the miner of the lane
+     * @return false once the space is exhausted
+     */
+    bool claim(unsigned _lane, uint64_t _count, NonceRange& _range);
+
+    NonceCoverage coverage() const;
+
+private:
+    // Offsets from m_start
+    struct Lane
+    {
+        uint64_t next = 0;
+        uint64_t end = 0;
+        uint64_t claimed = 0;
+        unsigned steals = 0;
+    };
+
+    bool refill(unsigned _lane, uint64_t _count);
+
+    mutable std::mutex x_lanes;
+    std::vector<Lane> m_lanes;
+
+    const uint64_t m_start;
+    const unsigned m_spaceBits;
+    uint64_t m_size;     // Nonces in the space, 2^64 - 1 for the whole
+    uint64_t m_segment;  // Size of the segments opened past the lanes
+    uint64_t m_tail;     // First offset not given to a lane yet
+    uint64_t m_claimed = 0;
+    unsigned m_steals = 0;
+    bool m_exhausted = false;
+};
+
+}  // namespace eth
+}  // namespace dev
@@ -0,0 +1,197 @@
+/*
+ This file is part of firominer.
+
+ firominer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ firominer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with firominer.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+
+#include <libdevcore/Log.h>
+#include <libethcore/SolutionVerifier.h>
+
+namespace dev
+{
+namespace eth
+{
+SolutionVerifier::Queue::Queue()
+{
+    for (size_t i = 0; i < kCapacity; i++)
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+bool SolutionVerifier::Queue::push(Solution const& _s)
+{
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Cell& cell = m_cells[pos & (kCapacity - 1)];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0)
+        {
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                cell.solution = _s;
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+            return false;  // Full
+        else
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+    }
+}
+
+bool SolutionVerifier::Queue::pop(Solution& _s)
+{
+    // Single consumer, the worker owning the queue
+    size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    Cell& cell = m_cells[pos & (kCapacity - 1)];
+    if (cell.sequence.load(std::memory_order_acquire) != pos + 1)
+        return false;
+    m_dequeuePos.store(pos + 1, std::memory_order_relaxed);
+    _s = std::move(cell.solution);
+    cell.sequence.store(pos + kCapacity, std::memory_order_release);
+    return true;
+}
+
+SolutionVerifier::SolutionVerifier(unsigned _threads, Verify _verify, Completed _completed)
+  : m_verify(std::move(_verify)), m_completed(std::move(_completed))
+{
+    if (!_threads)
+    {
+        // Bursts come from many GPUs at once, though a couple of threads keep
+        // up with low share difficulties without competing with CPU mining
+        unsigned hw = std::thread::hardware_concurrency();
+        _threads = std::max(1U, std::min(4U, hw / 4));
+    }
+
+    for (unsigned i = 0; i < _threads; i++)
+        m_workers.emplace_back(new WorkerThread);
+    for (unsigned i = 0; i < _threads; i++)
+        m_workers[i]->thread = std::thread(&SolutionVerifier::workLoop, this, i);
+}
+
+SolutionVerifier::~SolutionVerifier()
+{
+    m_stop.store(true, std::memory_order_relaxed);
+    for (auto& worker : m_workers)
+    {
+        worker->wake.signal();
+        worker->room.signal();
+    }
+    for (auto& worker : m_workers)
+        if (worker->thread.joinable())
+            worker->thread.join();
+}
+
+void SolutionVerifier::submit(Solution const& _s)
+{
+    WorkerThread& worker = *m_workers[_s.midx % m_workers.size()];
+
+    m_submitted.fetch_add(1, std::memory_order_relaxed);
+    unsigned queued = m_queued.fetch_add(1, std::memory_order_relaxed) + 1;
+    unsigned maxQueued = m_maxQueued.load(std::memory_order_relaxed);
+    while (queued > maxQueued && !m_maxQueued.compare_exchange_weak(maxQueued, queued))
+    {
+    }
+
+    if (!worker.queue.push(_s))
+    {
+        // Back-pressure: the miner waits for the worker to catch up. Miners
+        // sharing the worker wait one after the other, the event has a single waiter
+        m_throttled.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> l(worker.x_room);
+        while (!worker.queue.push(_s))
+        {
+            if (m_stop.load(std::memory_order_relaxed))
+            {
+                m_submitted.fetch_sub(1, std::memory_order_relaxed);
+                m_queued.fetch_sub(1, std::memory_order_relaxed);
+                return;
+            }
+            worker.room.wait();
+        }
+    }
+
+    worker.wake.signal();
+}
+
+void SolutionVerifier::workLoop(unsigned _index)
+{
+    setThreadName(("verify" + std::to_string(_index)).c_str());
+
+    WorkerThread& worker = *m_workers[_index];
+    std::vector<Solution> batch;
+    std::vector<SolutionCheck> checks;
+    Solution solution;
+    while (!m_stop.load(std::memory_order_relaxed))
+    {
+        batch.clear();
+        while (batch.size() < kMaxBatch && worker.queue.pop(solution))
+            batch.push_back(std::move(solution));
+
+        if (batch.empty())
+        {
+            worker.wake.wait();
+            continue;
+        }
+        worker.room.signal();
+
+        checks.assign(batch.size(), SolutionCheck::Invalid);
+        auto start = std::chrono::steady_clock::now();
+        m_verify(batch, checks);
+        uint64_t micros = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start)
+                              .count();
+
+        const auto unverified = (uint64_t)std::count(checks.begin(), checks.end(), SolutionCheck::Unverified);
+        m_verified.fetch_add(batch.size() - unverified, std::memory_order_relaxed);
+        m_unverified.fetch_add(unverified, std::memory_order_relaxed);
+        m_failed.fetch_add(
+            (uint64_t)std::count(checks.begin(), checks.end(), SolutionCheck::Invalid), std::memory_order_relaxed);
+        m_totalMicros.fetch_add(micros, std::memory_order_relaxed);
+        uint64_t each = micros / batch.size();
+        uint64_t maxMicros = m_maxMicros.load(std::memory_order_relaxed);
+        while (each > maxMicros && !m_maxMicros.compare_exchange_weak(maxMicros, each))
+        {
+        }
+
+        for (size_t i = 0; i < batch.size(); i++)
+            m_completed(batch[i], checks[i]);
+        m_queued.fetch_sub((unsigned)batch.size(), std::memory_order_relaxed);
+    }
+}
+
+VerifierStats SolutionVerifier::stats() const
+{
+    VerifierStats s;
+    s.threads = (unsigned)m_workers.size();
+    s.submitted = m_submitted.load(std::memory_order_relaxed);
+    s.verified = m_verified.load(std::memory_order_relaxed);
+    s.failed = m_failed.load(std::memory_order_relaxed);
+    s.unverified = m_unverified.load(std::memory_order_relaxed);
+    s.throttled = m_throttled.load(std::memory_order_relaxed);
+    s.queued = m_queued.load(std::memory_order_relaxed);
+    s.maxQueued = m_maxQueued.load(std::memory_order_relaxed);
+    s.maxMicros = m_maxMicros.load(std::memory_order_relaxed);
+    if (s.verified)
+        s.avgMicros = m_totalMicros.load(std::memory_order_relaxed) / s.verified;
+    return s;
+}
+
+}  // namespace eth
+}  // namespace dev
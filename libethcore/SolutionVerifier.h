@@ -0,0 +1,168 @@
+/*
+ This file is part of firominer.
+
+ firominer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ firominer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with firominer.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <libdevcore/WakeEvent.h>
+#include <libethcore/Miner.h>
+
+namespace dev
+{
+namespace eth
+{
+/// Outcome of the verification of a solution
+enum class SolutionCheck : char
+{
+    Invalid,
+    Valid,
+    Unverified  // The host could not check it, submitted as with --noeval
+};
+
+struct VerifierStats
+{
+    unsigned threads = 0;
+    uint64_t submitted = 0;   // Solutions handed to the pool
+    uint64_t verified = 0;    // Solutions whose verification completed (good or bad)
+    uint64_t failed = 0;      // Solutions which did not verify
+    uint64_t unverified = 0;  // Solutions the host had no context to verify
+    uint64_t throttled = 0;   // Submissions which had to wait for room in a full queue
+    unsigned queued = 0;      // Solutions waiting or being verified
+    unsigned maxQueued = 0;   // High water mark of the above
+    uint64_t avgMicros = 0;   // Average verification time of a solution
+    uint64_t maxMicros = 0;   // Longest verification time of a solution (batch average)
+    uint64_t cacheHits = 0;    // Dataset items read back from the item cache
+    uint64_t cacheMisses = 0;  // Dataset items computed from the light cache
+
+    // Filled by the farm, which picks the backend of each solution
+    std::string mode;             // Verify mode (light, cached, full)
+    bool fullReady = false;       // Whether the host DAG of full mode is built
+    struct Backend
+    {
+        uint64_t verified = 0;
+        uint64_t avgMicros = 0;     // Average wall time per solution
+        uint64_t avgCpuMicros = 0;  // Average CPU time per solution
+    };
+    Backend light;  // Light context, with or without the item cache
+    Backend full;   // Host DAG
+};
+
+/**
+ * @brief Pool of threads re-evaluating the solutions found by miners
+ *
+ * Verification in light mode recomputes dataset items from the light cache and
+ * takes milliseconds, so it is kept away from the io thread which serves stratum,
+ * the API and the timers.
+ *
+ * Each worker owns a bounded lock-free queue and the solutions of a miner always
+ * go to the same worker, so they complete in the order they were found. When the
+ * queue is full the submitting miner waits for room, slowing the one flooding
+ * the pool rather than dropping solutions. A worker takes what piled up in its
+ * queue, up to kMaxBatch solutions, and verifies them at once.
+ *
+ * @threadsafe
+ */
+class SolutionVerifier
+{
+public:
+    static constexpr size_t kMaxBatch = 16;
+
+    // Sets checks[i] to the outcome of solutions[i]
+    using Verify =
+        std::function<void(const std::vector<Solution>& solutions, std::vector<SolutionCheck>& checks)>;
+    using Completed = std::function<void(const Solution&, SolutionCheck)>;
+
+    /**
+     * @param _threads   Number of workers, 0 picks one for the host
+     * @param _verify    Checks a batch of solutions, run by workers
+     * @param _completed Receives each solution with its outcome, run by workers
+     */
+    SolutionVerifier(unsigned _threads, Verify _verify, Completed _completed);
+    ~SolutionVerifier();
+
+    SolutionVerifier(SolutionVerifier const&) = delete;
+    SolutionVerifier& operator=(SolutionVerifier const&) = delete;
+
+    /**
+     * @brief Queues a solution for verification. Blocks while the queue of the
+     * worker serving the miner is full
+     */
+    void submit(Solution const& _s);
+
+    VerifierStats stats() const;
+
+    unsigned threads() const { return (unsigned)m_workers.size(); }
+
+private:
+    // Bounded multi producer queue of a worker (D. Vyukov's sequence numbered ring)
+    class Queue
+    {
+    public:
+        Queue();
+        bool push(Solution const& _s);
+        bool pop(Solution& _s);
+
+    private:
+        static constexpr size_t kCapacity = 64;  // Power of 2
+
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            Solution solution;
+        };
+
+        Cell m_cells[kCapacity];
+        alignas(64) std::atomic<size_t> m_enqueuePos = {0};
+        alignas(64) std::atomic<size_t> m_dequeuePos = {0};
+    };
+
+    struct WorkerThread
+    {
+        Queue queue;
+        WakeEvent wake;     // Signaled by submitters, the queue is no longer empty
+        WakeEvent room;     // Signaled by the worker, the queue is no longer full
+        std::mutex x_room;  // Held by the one submitter waiting on room
+        std::thread thread;
+    };
+
+    void workLoop(unsigned _index);
+
+    Verify m_verify;
+    Completed m_completed;
+    std::vector<std::unique_ptr<WorkerThread>> m_workers;
+    std::atomic<bool> m_stop = {false};
+
+    std::atomic<uint64_t> m_submitted = {0};
+    std::atomic<uint64_t> m_verified = {0};
+    std::atomic<uint64_t> m_failed = {0};
+    std::atomic<uint64_t> m_unverified = {0};
+    std::atomic<uint64_t> m_throttled = {0};
+    std::atomic<unsigned> m_queued = {0};
+    std::atomic<unsigned> m_maxQueued = {0};
+    std::atomic<uint64_t> m_totalMicros = {0};
+    std::atomic<uint64_t> m_maxMicros = {0};
+};
+
+}  // namespace eth
+}  // namespace dev
@@ -64,9 +64,16 @@ void SimulateClient::submitSolution(const Solution& solution)
     }
     else if (solution.work.algo == "progpow")
     {
-        result = progpow::verify_full(solution.work.block.value(), ethash::from_bytes(solution.work.header.data()),
+        // Same path as the farm's verification pool
+        const uint64_t block{solution.work.block.value()};
+        const progpow::share share{ethash::from_bytes(solution.work.header.data()),
             ethash::from_bytes(solution.mixHash.data()), solution.nonce,
-            ethash::from_bytes(solution.work.get_boundary().data()));
+            ethash::from_bytes(solution.work.get_boundary().data())};
+        auto context{ethash::get_epoch_context(ethash::calculate_epoch_from_block_num(block), false)};
+        if (context)
+            result = progpow::verify_batch(*context, uint32_t(block / progpow::kPeriodLength), &share, 1, 1).front();
+        else
+            result = ethash::VerificationResult::kInvalidMixHash;
     }
 
     bool accepted = (result == ethash::VerificationResult::kOk);
@@ -0,0 +1,127 @@
+/*
+ This file is part of firominer.
+
+ firominer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ firominer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with firominer.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks epoch contexts stored on disk map back identical and corrupted files are
+// refused. POSIX only, like the cache. Exits with 1 on the first failure.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <libcrypto/epoch_cache.hpp>
+
+namespace
+{
+const uint32_t c_epoch = 3;
+
+// The file of the epoch, once the background store published it
+std::string waitForFile(const std::string& _dir)
+{
+    for (int i = 0; i < 300; i++)
+    {
+        DIR* d = opendir(_dir.c_str());
+        std::string found;
+        while (dirent* entry = readdir(d))
+            if (std::strstr(entry->d_name, ".light") && !std::strstr(entry->d_name, ".tmp"))
+                found = _dir + "/" + entry->d_name;
+        closedir(d);
+        if (!found.empty())
+            return found;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return {};
+}
+
+bool sameContext(const ethash::epoch_context& _a, const ethash::epoch_context& _b)
+{
+    return _a.epoch_number == _b.epoch_number && _a.light_cache_num_items == _b.light_cache_num_items &&
+           std::memcmp(_a.light_cache, _b.light_cache, _a.light_cache_size) == 0 &&
+           std::memcmp(_a.l1_cache, _b.l1_cache, ethash::kL1_cache_size) == 0;
+}
+
+bool check(const std::string& _dir)
+{
+    ethash::set_epoch_cache_dir(_dir);
+    if (ethash::detail::epoch_cache_enabled(true))
+    {
+        std::printf("full datasets persisted by default\n");
+        return false;
+    }
+
+    auto built = ethash::get_epoch_context(c_epoch, false);
+    const std::string path = waitForFile(_dir);
+    if (!built || path.empty())
+    {
+        std::printf("context of epoch %u not stored in %s\n", c_epoch, _dir.c_str());
+        return false;
+    }
+
+    auto* loaded = ethash::detail::load_epoch_context(c_epoch, false);
+    if (!loaded || !sameContext(*built, *loaded))
+    {
+        std::printf("stored context of epoch %u does not load back identical\n", c_epoch);
+        return false;
+    }
+    ethash::detail::unload_epoch_context(loaded);
+
+    // Flip a byte of the light cache, the checksum must catch it
+    int fd = open(path.c_str(), O_RDWR);
+    char byte = 0;
+    const off_t offset = 4096 + 1000;
+    bool flipped = fd >= 0 && pread(fd, &byte, 1, offset) == 1;
+    byte ^= 1;
+    flipped = flipped && pwrite(fd, &byte, 1, offset) == 1;
+    if (fd >= 0)
+        close(fd);
+    if (!flipped)
+    {
+        std::printf("unable to corrupt %s\n", path.c_str());
+        return false;
+    }
+    loaded = ethash::detail::load_epoch_context(c_epoch, false);
+    if (loaded)
+    {
+        ethash::detail::unload_epoch_context(loaded);
+        std::printf("corrupted %s loaded\n", path.c_str());
+        return false;
+    }
+    unlink(path.c_str());
+    return true;
+}
+
+}  // namespace
+
+int main()
+{
+    char dir[] = "/tmp/firominer-check-XXXXXX";
+    if (!mkdtemp(dir))
+    {
+        std::printf("unable to create a temporary directory\n");
+        return 1;
+    }
+    const bool ok = check(dir);
+    ethash::set_epoch_cache_dir("");
+    rmdir(dir);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+/*
+ This file is part of firominer.
+
+ firominer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ firominer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with firominer.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks the NonceAllocator never hands out a nonce twice and, when the space is
+// bounded, hands out all of it. Exits with 1 on the first failure.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <libethcore/NonceAllocator.h>
+
+using namespace dev::eth;
+
+namespace
+{
+const uint64_t c_start = 0xabcd000000000000ULL;
+
+// Marks the range in _seen, false if a nonce is out of the space or seen already
+bool mark(std::vector<char>& _seen, NonceRange const& _range)
+{
+    for (uint64_t i = 0; i < _range.count; i++)
+    {
+        uint64_t offset = _range.first + i - c_start;
+        if (offset >= _seen.size() || _seen[offset]++)
+            return false;
+    }
+    return true;
+}
+
+// Miners claim at different paces until the space runs out
+bool checkBounded(unsigned _spaceBits, std::vector<float> const& _hashrates, uint64_t _batch)
+{
+    NonceAllocator allocator(c_start, _spaceBits, 32, _hashrates);
+    std::vector<char> seen(size_t(1) << _spaceBits, 0);
+    uint64_t total = 0;
+    for (bool more = true; more;)
+    {
+        more = false;
+        for (unsigned lane = 0; lane < _hashrates.size(); lane++)
+        {
+            NonceRange range;
+            for (unsigned i = 0; i <= lane && allocator.claim(lane, _batch, range); i++)
+            {
+                more = true;
+                total += range.count;
+                if (!mark(seen, range))
+                {
+                    std::printf("%u bits: nonce of [%llx, +%llu) out of the space or handed out twice\n",
+                        _spaceBits, (unsigned long long)range.first, (unsigned long long)range.count);
+                    return false;
+                }
+            }
+        }
+    }
+
+    auto coverage = allocator.coverage();
+    if (total != seen.size() || coverage.claimed != total || !coverage.exhausted)
+    {
+        std::printf("%u bits: %llu of %zu nonces handed out\n", _spaceBits, (unsigned long long)total,
+            seen.size());
+        return false;
+    }
+    return true;
+}
+
+// Same with miners claiming concurrently
+bool checkConcurrent(unsigned _spaceBits, unsigned _miners)
+{
+    NonceAllocator allocator(c_start, _spaceBits, 32, std::vector<float>(_miners, 0.0f));
+    std::vector<std::vector<NonceRange>> ranges(_miners);
+    std::vector<std::thread> threads;
+    for (unsigned lane = 0; lane < _miners; lane++)
+        threads.emplace_back([&allocator, &ranges, lane]() {
+            NonceRange range;
+            while (allocator.claim(lane, 16 + lane * 8, range))
+                ranges[lane].push_back(range);
+        });
+    for (auto& thread : threads)
+        thread.join();
+
+    std::vector<char> seen(size_t(1) << _spaceBits, 0);
+    uint64_t total = 0;
+    for (auto const& lane : ranges)
+        for (auto const& range : lane)
+        {
+            total += range.count;
+            if (!mark(seen, range))
+            {
+                std::printf("%u bits, %u miners: nonce handed out twice\n", _spaceBits, _miners);
+                return false;
+            }
+        }
+    if (total != seen.size())
+    {
+        std::printf("%u bits, %u miners: %llu of %zu nonces handed out\n", _spaceBits, _miners,
+            (unsigned long long)total, seen.size());
+        return false;
+    }
+    return true;
+}
+
+// Paused miners start with an empty lane, unmeasured ones with the average share
+bool checkPaused()
+{
+    NonceAllocator allocator(c_start, 16, 32, {100.0f, -1.0f, 0.0f, 300.0f});
+    auto lanes = allocator.coverage().lanes;
+    uint64_t sizes[4];
+    for (unsigned i = 0; i < 4; i++)
+        sizes[i] = lanes[i].end - lanes[i].next;
+    // Shares are rounded to whole nonces
+    if (sizes[1] || sizes[2] + 2 < 2 * sizes[0] || sizes[2] > 2 * sizes[0] + 2 ||
+        sizes[0] + sizes[2] + sizes[3] != (1U << 16))
+    {
+        std::printf("16 bits: lanes of %llu %llu %llu %llu nonces\n", (unsigned long long)sizes[0],
+            (unsigned long long)sizes[1], (unsigned long long)sizes[2], (unsigned long long)sizes[3]);
+        return false;
+    }
+    return true;
+}
+
+// The whole space only opens segments, which must not overlap either
+bool checkUnbounded()
+{
+    NonceAllocator allocator(c_start, 64, 12, {100.0f, 0.0f, -1.0f});
+    std::vector<NonceRange> ranges;
+    NonceRange range;
+    for (unsigned i = 0; i < 3000; i++)
+    {
+        if (!allocator.claim(i % 3, 1000, range))
+        {
+            std::printf("64 bits: claim %u failed\n", i);
+            return false;
+        }
+        ranges.push_back(range);
+    }
+
+    std::sort(ranges.begin(), ranges.end(),
+        [](NonceRange const& _a, NonceRange const& _b) { return _a.first < _b.first; });
+    for (size_t i = 1; i < ranges.size(); i++)
+        if (ranges[i - 1].first + ranges[i - 1].count > ranges[i].first)
+        {
+            std::printf("64 bits: [%llx, +%llu) overlaps the next range\n",
+                (unsigned long long)ranges[i - 1].first, (unsigned long long)ranges[i - 1].count);
+            return false;
+        }
+    return true;
+}
+
+}  // namespace
+
+int main()
+{
+    bool ok = checkBounded(0, {1.0f}, 1) && checkBounded(5, {1.0f, 1.0f, 1.0f}, 10) &&
+              checkBounded(12, {100.0f, 200.0f, 0.0f}, 64) && checkBounded(16, {100.0f, -1.0f, 500.0f}, 100) &&
+              checkBounded(16, {-1.0f, -1.0f}, 256) && checkBounded(10, {1.0f, 1e6f}, 7) &&
+              checkConcurrent(16, 4) && checkConcurrent(20, 8) && checkPaused() && checkUnbounded();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,207 @@
+/*
+ This file is part of firominer.
+
+ firominer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ firominer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with firominer.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks the host ProgPoW engines against known hashes and against their references,
+// on every instruction set tier of the host. Exits with 1 on the first mismatch.
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <libcrypto/dispatch.hpp>
+#include <libcrypto/progpow.hpp>
+
+namespace
+{
+const char* to_cstr(ethash::VerificationResult _r)
+{
+    switch (_r)
+    {
+    case ethash::VerificationResult::kOk:
+        return "ok";
+    case ethash::VerificationResult::kInvalidNonce:
+        return "invalid nonce";
+    default:
+        return "invalid mix hash";
+    }
+}
+
+// Hashes computed by the implementation firominer started from
+struct GoldenHash
+{
+    uint64_t block;
+    const char* header;
+    uint64_t nonce;
+    const char* mix;
+    const char* final;
+};
+
+const GoldenHash c_golden[] = {
+    {0, "ffeeddccbbaa9988776655443322110000112233445566778899aabbccddeeff", 0x123456789abcdef0ULL,
+        "06e56bcb1876d6cd54ee4127aad4bb75b0972d74e3474bdca42f995ad52bc2f6",
+        "275d04a8df2db70e1756aa24995e6fc0a82571da492e7f816c1056933d0bd3c6"},
+    {1299, "0000000000000000000000000000000000000000000000000000000000000000", 0,
+        "31179bfdb818b1c5f489a30d108cd304929f78e0545a22284cb27f0ff486e313",
+        "838f431c8cc73d193792908487956ee7d505faa707680dbdba9a876e0a6a0759"},
+    {30000, "ffeeddccbbaa9988776655443322110000112233445566778899aabbccddeeff", 0x123456789abcdef0ULL,
+        "337367d0c05fcca478918fe64a8b4e05b37cf686333930fdf3cd515b17d90b3b",
+        "2b7a96930757bc925bfd957f2941258e5a4c2a57421254697f3be036e89f0f7c"},
+};
+
+ethash::hash256 fromHex(const char* _hex)
+{
+    ethash::hash256 h;
+    for (size_t i = 0; i < sizeof(h.bytes); i++)
+    {
+        unsigned byte = 0;
+        std::sscanf(_hex + 2 * i, "%2x", &byte);
+        h.bytes[i] = uint8_t(byte);
+    }
+    return h;
+}
+
+// progpow::hash() and the interleaved hash_batch() against the known hashes
+bool checkGolden()
+{
+    for (auto const& g : c_golden)
+    {
+        auto context = ethash::get_epoch_context(ethash::calculate_epoch_from_block_num(g.block), false);
+        if (!context)
+        {
+            std::printf("Unable to build the context of block %llu\n", (unsigned long long)g.block);
+            return false;
+        }
+        const uint32_t period = uint32_t(g.block / progpow::kPeriodLength);
+        const auto header = fromHex(g.header);
+        ethash::result batch[3];
+        progpow::hash_batch(*context, *progpow::get_program(period), header, g.nonce - 1, 3, batch);
+        for (auto const& r : {progpow::hash(*context, period, header, g.nonce), batch[1]})
+        {
+            if (ethash::to_hex(r.mix_hash) != g.mix || ethash::to_hex(r.final_hash) != g.final)
+            {
+                std::printf("Block %llu nonce %llx hashes to mix %s final %s\n", (unsigned long long)g.block,
+                    (unsigned long long)g.nonce, ethash::to_hex(r.mix_hash).c_str(),
+                    ethash::to_hex(r.final_hash).c_str());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// The lane engine of hash_mix() against the scalar hash_mix_reference()
+bool checkMix(const ethash::epoch_context& _context)
+{
+    for (uint64_t period = 0; period < 24; period++)
+    {
+        auto prog = progpow::get_program(period * 7919);
+        for (uint64_t i = 0; i < 4; i++)
+        {
+            const uint64_t seed = i * 0x9e3779b97f4a7c15ULL + period;
+            auto mix = progpow::hash_mix(_context, *prog, seed);
+            auto reference = progpow::hash_mix_reference(_context, *prog, seed);
+            if (std::memcmp(&mix, &reference, sizeof(mix)) != 0)
+            {
+                std::printf("hash_mix differs from the reference, period %llu seed %llx\n",
+                    (unsigned long long)(period * 7919), (unsigned long long)seed);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// verify_batch() against verify_full() one share at a time, with good shares, shares
+// above their boundary and shares with a wrong mix hash
+bool checkBatch(const ethash::epoch_context& _context)
+{
+    const uint32_t period = 11;
+    // Enough surviving shares to spread them over worker threads
+    std::vector<progpow::share> shares(192);
+    for (size_t i = 0; i < shares.size(); i++)
+    {
+        auto& s = shares[i];
+        std::memset(&s, 0, sizeof(s));
+        s.header_hash.word64s[0] = i * 0x100000001b3ULL;
+        s.nonce = i * 7919;
+        auto r = progpow::hash(_context, period, s.header_hash, s.nonce);
+        s.mix_hash = r.mix_hash;
+        switch (i % 4)
+        {
+        case 0:
+            std::memset(&s.boundary, 0xff, sizeof(s.boundary));
+            break;
+        case 1:
+            break;  // Zero boundary, the final hash is above
+        case 2:
+            s.boundary = r.final_hash;  // Just at the boundary
+            break;
+        case 3:
+            std::memset(&s.boundary, 0xff, sizeof(s.boundary));
+            s.mix_hash.word32s[i % 8] ^= 1;
+            break;
+        }
+    }
+
+    for (unsigned threads : {1U, 0U})
+    {
+        auto results = progpow::verify_batch(_context, period, shares.data(), shares.size(), threads);
+        if (results.size() != shares.size())
+        {
+            std::printf("verify_batch returned %zu results for %zu shares\n", results.size(), shares.size());
+            return false;
+        }
+        for (size_t i = 0; i < shares.size(); i++)
+        {
+            const auto& s = shares[i];
+            auto expected = progpow::verify_full(_context, period, s.header_hash, s.mix_hash, s.nonce, s.boundary);
+            if (results[i] != expected)
+            {
+                std::printf("verify_batch says %s instead of %s for share %zu (%u threads)\n",
+                    to_cstr(results[i]), to_cstr(expected), i, threads);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main()
+{
+    auto context = ethash::get_epoch_context(0, false);
+    if (!context)
+    {
+        std::printf("Unable to build the context of epoch 0\n");
+        return 1;
+    }
+
+    const auto detected = crypto::detected_simd_level();
+    for (auto level : {crypto::simd_level::generic, crypto::simd_level::sse4, crypto::simd_level::avx2,
+             crypto::simd_level::avx512})
+    {
+        if (level > detected)
+            break;
+        crypto::select_simd_level(level);
+        std::printf("%s\n", crypto::to_string(level).c_str());
+        if (!checkGolden() || !checkMix(*context) || !checkBatch(*context))
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ This file is part of firominer.
+
+ firominer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ firominer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with firominer.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks the SolutionVerifier completes every solution once, in the order each miner
+// found them, while miners flooding it are held back. Exits with 1 on failure.
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <libethcore/SolutionVerifier.h>
+
+using namespace dev::eth;
+
+int main()
+{
+    const unsigned miners = 6;
+    const uint64_t perMiner = 3000;
+
+    std::mutex x_completed;
+    std::vector<std::vector<uint64_t>> completed(miners);
+    std::vector<uint64_t> outcomes(3, 0);
+    {
+        // One slow worker for all, the queue fills up
+        SolutionVerifier verifier(
+            1,
+            [](const std::vector<Solution>& _s, std::vector<SolutionCheck>& _checks) {
+                std::this_thread::sleep_for(std::chrono::microseconds(20 * _s.size()));
+                for (size_t i = 0; i < _s.size(); i++)
+                    _checks[i] = SolutionCheck(_s[i].nonce % 3);
+            },
+            [&](const Solution& _s, SolutionCheck _check) {
+                std::lock_guard<std::mutex> l(x_completed);
+                completed[_s.midx].push_back(_s.nonce);
+                outcomes[size_t(_check)]++;
+            });
+
+        std::vector<std::thread> threads;
+        for (unsigned m = 0; m < miners; m++)
+            threads.emplace_back([&verifier, m, perMiner]() {
+                for (uint64_t n = 0; n < perMiner; n++)
+                {
+                    Solution s;
+                    s.midx = m;
+                    s.nonce = n;
+                    verifier.submit(s);
+                }
+            });
+        for (auto& thread : threads)
+            thread.join();
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (verifier.stats().queued && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        auto stats = verifier.stats();
+        const uint64_t total = miners * perMiner;
+        if (stats.submitted != total || stats.verified + stats.unverified != total ||
+            stats.failed != outcomes[size_t(SolutionCheck::Invalid)] ||
+            stats.unverified != outcomes[size_t(SolutionCheck::Unverified)] || !stats.throttled)
+        {
+            std::printf("stats: submitted %llu verified %llu failed %llu unverified %llu throttled %llu\n",
+                (unsigned long long)stats.submitted, (unsigned long long)stats.verified,
+                (unsigned long long)stats.failed, (unsigned long long)stats.unverified,
+                (unsigned long long)stats.throttled);
+            return 1;
+        }
+    }
+
+    for (unsigned m = 0; m < miners; m++)
+    {
+        bool ordered = completed[m].size() == perMiner;
+        for (uint64_t n = 0; ordered && n < perMiner; n++)
+            ordered = completed[m][n] == n;
+        if (!ordered)
+        {
+            std::printf("solutions of miner %u lost or out of order\n", m);
+            return 1;
+        }
+    }
+    return 0;
+}
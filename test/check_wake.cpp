@@ -0,0 +1,103 @@
+/*
+ This file is part of firominer.
+
+ firominer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ firominer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with firominer.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks WakeEvent neither loses signals nor wakes without one. Exits with 1 on
+// the first failure.
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#include <libdevcore/WakeEvent.h>
+
+using namespace dev;
+using namespace std::chrono_literals;
+
+namespace
+{
+bool checkSingleThread()
+{
+    WakeEvent event;
+    if (event.waitFor(10ms))
+    {
+        std::printf("waitFor() returned true without a signal\n");
+        return false;
+    }
+
+    // Signals before the wait are kept, several of them wake once
+    event.signal();
+    event.signal();
+    if (!event.waitFor(0ms) || event.waitFor(10ms))
+    {
+        std::printf("signals before the wait not kept once\n");
+        return false;
+    }
+
+    event.signal();
+    if (!event.reset() || event.reset())
+    {
+        std::printf("reset() does not clear the event\n");
+        return false;
+    }
+    return true;
+}
+
+// Two threads hand a token back and forth, any lost signal hangs one of them
+bool checkPingPong()
+{
+    const unsigned rounds = 100000;
+    WakeEvent ping, pong;
+    std::atomic<unsigned> turn = {0};
+    std::atomic<bool> stuck = {false};
+
+    std::thread other([&]() {
+        for (unsigned i = 0; i < rounds; i++)
+        {
+            while (turn.load() != 2 * i + 1)
+                if (!ping.waitFor(2000ms))
+                {
+                    stuck = true;
+                    return;
+                }
+            turn.store(2 * i + 2);
+            pong.signal();
+        }
+    });
+    for (unsigned i = 0; i < rounds && !stuck; i++)
+    {
+        turn.store(2 * i + 1);
+        ping.signal();
+        while (turn.load() != 2 * i + 2 && !stuck)
+            if (!pong.waitFor(2000ms))
+                stuck = true;
+    }
+    other.join();
+
+    if (stuck)
+    {
+        std::printf("signal lost after %u rounds\n", turn.load() / 2);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main()
+{
+    return checkSingleThread() && checkPingPong() ? 0 : 1;
+}